@@ -0,0 +1,111 @@
+#include "aim_odds.h"
+#include <random>
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+AimOddsWorker::AimOddsWorker(const TableLayout &layout, int maxSamples, float angleSigma, float powerSigma)
+    : layout(layout), maxSamples(maxSamples), angleSigma(angleSigma), powerSigma(powerSigma) {
+    jobBalls.reserve(16);   // aim() copies into this every time the aim moves
+    worker = std::thread([this] { workerLoop(); });
+}
+
+AimOddsWorker::~AimOddsWorker() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+static bool SameBalls(const std::vector<Ball> &a, const std::vector<Ball> &b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i=0;i<a.size();++i)
+        if (a[i].active != b[i].active || a[i].pos.x != b[i].pos.x || a[i].pos.y != b[i].pos.y) return false;
+    return true;
+}
+
+// The caller-side entry points only try_lock: a worker holding the mutex
+// (or preempted while holding it on a single core) costs the render loop a
+// frame-old answer, never a wait.
+
+void AimOddsWorker::aim(const std::vector<Ball> &balls, float angle, float power) {
+    {
+        std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+        if (!lock.owns_lock()) return;   // retried next frame
+        if (hasJob && angle == jobAngle && power == jobPower && SameBalls(balls, jobBalls)) return;
+        hasJob = true;
+        generation++;
+        jobBalls = balls;
+        jobAngle = angle;
+        jobPower = power;
+        odds = AimOdds();
+        shown = AimOdds();
+    }
+    cv.notify_one();
+}
+
+void AimOddsWorker::cancel() {
+    shown = AimOdds();
+    std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+    if (!lock.owns_lock() || !hasJob) return;   // retried next frame
+    hasJob = false;
+    generation++;
+    odds = AimOdds();
+}
+
+bool AimOddsWorker::busy() const {
+    std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+    if (!lock.owns_lock()) return true;
+    return hasJob && odds.samples < maxSamples;
+}
+
+AimOdds AimOddsWorker::latest() {
+    std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+    if (lock.owns_lock()) shown = odds;
+    return shown;
+}
+
+void AimOddsWorker::workerLoop() {
+#if defined(__linux__)
+    // below the render thread, so a busy core preempts sampling, not drawing
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+    TableSim sim(layout);
+    std::vector<Ball> start;
+    start.reserve(16);
+    float angle = 0.0f, power = 0.0f;
+    unsigned gen = 0;
+    std::mt19937 rng;
+    std::normal_distribution<float> jitter(0.0f, 1.0f);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this] { return stopping || (hasJob && odds.samples < maxSamples); });
+            if (stopping) return;
+            if (gen != generation) {
+                gen = generation;
+                start = jobBalls;
+                angle = jobAngle;
+                power = jobPower;
+                rng.seed(gen);
+            }
+        }
+        // One sample is a single shot (tens of microseconds with the event
+        // engine), so a moved aim is picked up almost at once.
+        sim.balls = start;
+        float p = clampf_custom(power * (1.0f + powerSigma * jitter(rng)), 0.0f, MAX_POWER);
+        sim.shoot(angle + angleSigma * jitter(rng), p);
+        sim.advanceUntilRest();
+
+        std::lock_guard<std::mutex> lock(m);
+        if (gen != generation) continue;   // aim moved while simulating
+        odds.samples++;
+        bool seen[16] = { false };
+        for (int id : sim.shotPocketed)
+            if (id >= 0 && id < 16 && !seen[id]) { seen[id] = true; odds.pocketed[id]++; }
+    }
+}
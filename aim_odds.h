@@ -0,0 +1,58 @@
+// Background Monte Carlo estimate of what the current aim pockets.
+// A worker thread replays the shot with jittered angle and power and keeps
+// running counts; the render thread only ever copies the latest counts.
+
+#ifndef AIM_ODDS_H
+#define AIM_ODDS_H
+
+#include "table_sim.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct AimOdds {
+    int samples = 0;
+    int pocketed[16] = { 0 };   // samples in which ball id went down (0 = scratch)
+
+    float chance(int id) const { return (samples > 0 && id >= 0 && id < 16) ? (float)pocketed[id] / samples : 0.0f; }
+};
+
+class AimOddsWorker {
+public:
+    explicit AimOddsWorker(const TableLayout &layout, int maxSamples = 2000,
+                           float angleSigma = 0.008f, float powerSigma = 0.04f);
+    ~AimOddsWorker();
+    AimOddsWorker(const AimOddsWorker &) = delete;
+    AimOddsWorker &operator=(const AimOddsWorker &) = delete;
+
+    // Call every frame while aiming. A changed table, angle or power drops the
+    // running counts and restarts; the same aim keeps accumulating.
+    void aim(const std::vector<Ball> &balls, float angle, float power);
+    // like aim(), call every frame while not aiming
+    void cancel();
+    // still sampling towards maxSamples
+    bool busy() const;
+    // never blocks: falls back to the last counts read when the worker holds the lock
+    AimOdds latest();
+
+private:
+    const TableLayout layout;
+    const int maxSamples;
+    const float angleSigma, powerSigma;   // absolute radians, fraction of power
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    bool stopping = false;
+    bool hasJob = false;
+    unsigned generation = 0;              // bumped on every restart or cancel
+    std::vector<Ball> jobBalls;
+    float jobAngle = 0.0f, jobPower = 0.0f;
+    AimOdds odds;
+    AimOdds shown;                        // caller thread only
+    std::thread worker;
+
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "alloc_check.h"
+
+#ifdef BILLIARD_ALLOC_CHECK
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long> allocs{0};
+
+long AllocCount() { return allocs.load(std::memory_order_relaxed); }
+
+// The other forms (arrays, nothrow) forward to these in the standard
+// library, so they are counted and freed consistently too.
+void *operator new(std::size_t size) {
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,19 @@
+// Heap allocation counting, for checking that steady-state loops never
+// allocate. Build with -DBILLIARD_ALLOC_CHECK and alloc_check.cpp replaces the
+// global operator new / delete with counting versions; without the flag the
+// file is empty and nothing is replaced.
+//
+// The count is process-wide: an allocation on a worker (the shot search,
+// the aim odds) counts against whatever the checking thread is timing.
+
+#ifndef ALLOC_CHECK_H
+#define ALLOC_CHECK_H
+
+#ifdef BILLIARD_ALLOC_CHECK
+
+// operator new calls made by any thread so far
+long AllocCount();
+
+#endif
+
+#endif
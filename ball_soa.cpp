@@ -0,0 +1,275 @@
+#include "ball_soa.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SOA_X86 1
+#endif
+
+static const float FAR_AWAY = 1e18f;
+
+void BallSoA::resize(int n) {
+    count = n;
+    int padded = (n + SOA_LANES - 1) / SOA_LANES * SOA_LANES;
+    x.assign(padded, FAR_AWAY); y.assign(padded, FAR_AWAY);
+    vx.assign(padded, 0.0f); vy.assign(padded, 0.0f);
+    id.assign(padded, -1);
+    active.assign((padded + 63) / 64, 0);
+    mask.assign(active.size(), 0);
+    // about a dozen neighbours per ball inside the 4R candidate slack, even packed
+    if (pairs.capacity() < (size_t)padded * 16) pairs.reserve((size_t)padded * 16);
+    solver.reserve(padded, (size_t)padded * 16);
+}
+
+void BallSoA::setActive(int i, bool on) {
+    if (on) active[i >> 6] |= (uint64_t)1 << (i & 63);
+    else { active[i >> 6] &= ~((uint64_t)1 << (i & 63)); vx[i] = vy[i] = 0.0f; }
+}
+
+bool BallSoA::atRest() const {
+    for (size_t i=0;i<vx.size();i++) if (vx[i] != 0.0f || vy[i] != 0.0f) return false;
+    return true;
+}
+
+void BallSoA::load(const std::vector<Ball> &balls) {
+    resize((int)balls.size());
+    solver.forget();
+    for (int i=0;i<count;i++) {
+        const Ball &b = balls[i];
+        x[i] = b.pos.x; y[i] = b.pos.y;
+        id[i] = b.id;
+        setActive(i, b.active);
+        if (b.active) { vx[i] = b.vel.x; vy[i] = b.vel.y; }
+    }
+}
+
+void BallSoA::store(std::vector<Ball> &balls) const {
+    balls.resize(count);
+    for (int i=0;i<count;i++) balls[i] = { { x[i], y[i] }, { vx[i], vy[i] }, isActive(i), id[i], 0 };
+}
+
+// 8 active bits for lanes j..j+7 (j is a multiple of 8, so never spans a word)
+static inline unsigned ActiveByte(const BallSoA &b, int j) { return (unsigned)(b.active[j >> 6] >> (j & 63)) & 0xFFu; }
+
+// ---------------- Scalar ----------------
+
+static void IntegrateScalar(BallSoA &b, float friction, float minVel) {
+    int n = (int)b.x.size();
+    for (int i=0;i<n;i++) {
+        b.x[i] += b.vx[i]; b.y[i] += b.vy[i];
+        b.vx[i] *= friction; b.vy[i] *= friction;
+        if (fabsf(b.vx[i]) < minVel) b.vx[i] = 0.0f;
+        if (fabsf(b.vy[i]) < minVel) b.vy[i] = 0.0f;
+    }
+}
+
+static void WithinAnyScalar(const BallSoA &b, const Vector2 *pts, int nPts, float r, uint64_t *outMask) {
+    int n = (int)b.x.size();
+    for (int w=0; w<(n+63)/64; w++) outMask[w] = 0;
+    float r2 = r*r;
+    for (int i=0;i<b.count;i++) {
+        if (!b.isActive(i)) continue;
+        for (int k=0;k<nPts;k++) {
+            float dx = b.x[i]-pts[k].x, dy = b.y[i]-pts[k].y;
+            if (dx*dx + dy*dy < r2) { outMask[i >> 6] |= (uint64_t)1 << (i & 63); break; }
+        }
+    }
+}
+
+static void OverlapPairsScalar(const BallSoA &b, float dist, std::vector<int> &pairs) {
+    float d2 = dist*dist;
+    for (int i=0;i<b.count;i++) {
+        if (!b.isActive(i)) continue;
+        for (int j=i+1;j<b.count;j++) {
+            if (!b.isActive(j)) continue;
+            float dx = b.x[j]-b.x[i], dy = b.y[j]-b.y[i];
+            if (dx*dx + dy*dy < d2) { pairs.push_back(i); pairs.push_back(j); }
+        }
+    }
+}
+
+#ifdef SOA_X86
+
+// ---------------- SSE2 (4 lanes) ----------------
+
+static void IntegrateSSE2(BallSoA &b, float friction, float minVel) {
+    const __m128 f = _mm_set1_ps(friction), mv = _mm_set1_ps(minVel);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    int n = (int)b.x.size();
+    for (int i=0;i<n;i+=4) {
+        __m128 vx = _mm_loadu_ps(&b.vx[i]), vy = _mm_loadu_ps(&b.vy[i]);
+        _mm_storeu_ps(&b.x[i], _mm_add_ps(_mm_loadu_ps(&b.x[i]), vx));
+        _mm_storeu_ps(&b.y[i], _mm_add_ps(_mm_loadu_ps(&b.y[i]), vy));
+        vx = _mm_mul_ps(vx, f); vy = _mm_mul_ps(vy, f);
+        vx = _mm_andnot_ps(_mm_cmplt_ps(_mm_and_ps(vx, absMask), mv), vx);
+        vy = _mm_andnot_ps(_mm_cmplt_ps(_mm_and_ps(vy, absMask), mv), vy);
+        _mm_storeu_ps(&b.vx[i], vx); _mm_storeu_ps(&b.vy[i], vy);
+    }
+}
+
+static void WithinAnySSE2(const BallSoA &b, const Vector2 *pts, int nPts, float r, uint64_t *outMask) {
+    int n = (int)b.x.size();
+    for (int w=0; w<(n+63)/64; w++) outMask[w] = 0;
+    const __m128 r2 = _mm_set1_ps(r*r);
+    for (int i=0;i<n;i+=8) {
+        unsigned bits = 0;
+        for (int h=0;h<2;h++) {
+            __m128 px = _mm_loadu_ps(&b.x[i+4*h]), py = _mm_loadu_ps(&b.y[i+4*h]);
+            __m128 hit = _mm_setzero_ps();
+            for (int k=0;k<nPts;k++) {
+                __m128 dx = _mm_sub_ps(px, _mm_set1_ps(pts[k].x)), dy = _mm_sub_ps(py, _mm_set1_ps(pts[k].y));
+                hit = _mm_or_ps(hit, _mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), r2));
+            }
+            bits |= (unsigned)_mm_movemask_ps(hit) << (4*h);
+        }
+        outMask[i >> 6] |= (uint64_t)(bits & ActiveByte(b, i)) << (i & 63);
+    }
+}
+
+static void OverlapPairsSSE2(const BallSoA &b, float dist, std::vector<int> &pairs) {
+    const __m128 d2 = _mm_set1_ps(dist*dist);
+    for (int i=0;i<b.count;i++) {
+        if (!b.isActive(i)) continue;
+        const __m128 px = _mm_set1_ps(b.x[i]), py = _mm_set1_ps(b.y[i]);
+        for (int j=(i+1) & ~7; j<b.count; j+=8) {
+            unsigned bits = 0;
+            for (int h=0;h<2;h++) {
+                __m128 dx = _mm_sub_ps(_mm_loadu_ps(&b.x[j+4*h]), px), dy = _mm_sub_ps(_mm_loadu_ps(&b.y[j+4*h]), py);
+                bits |= (unsigned)_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), d2)) << (4*h);
+            }
+            bits &= ActiveByte(b, j);
+            if (j <= i) bits &= ~0u << (i + 1 - j);
+            while (bits) { int k = __builtin_ctz(bits); pairs.push_back(i); pairs.push_back(j + k); bits &= bits - 1; }
+        }
+    }
+}
+
+// ---------------- AVX2 (8 lanes) ----------------
+
+__attribute__((target("avx2")))
+static void IntegrateAVX2(BallSoA &b, float friction, float minVel) {
+    const __m256 f = _mm256_set1_ps(friction), mv = _mm256_set1_ps(minVel);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    int n = (int)b.x.size();
+    for (int i=0;i<n;i+=8) {
+        __m256 vx = _mm256_loadu_ps(&b.vx[i]), vy = _mm256_loadu_ps(&b.vy[i]);
+        _mm256_storeu_ps(&b.x[i], _mm256_add_ps(_mm256_loadu_ps(&b.x[i]), vx));
+        _mm256_storeu_ps(&b.y[i], _mm256_add_ps(_mm256_loadu_ps(&b.y[i]), vy));
+        vx = _mm256_mul_ps(vx, f); vy = _mm256_mul_ps(vy, f);
+        vx = _mm256_andnot_ps(_mm256_cmp_ps(_mm256_and_ps(vx, absMask), mv, _CMP_LT_OQ), vx);
+        vy = _mm256_andnot_ps(_mm256_cmp_ps(_mm256_and_ps(vy, absMask), mv, _CMP_LT_OQ), vy);
+        _mm256_storeu_ps(&b.vx[i], vx); _mm256_storeu_ps(&b.vy[i], vy);
+    }
+}
+
+__attribute__((target("avx2")))
+static void WithinAnyAVX2(const BallSoA &b, const Vector2 *pts, int nPts, float r, uint64_t *outMask) {
+    int n = (int)b.x.size();
+    for (int w=0; w<(n+63)/64; w++) outMask[w] = 0;
+    const __m256 r2 = _mm256_set1_ps(r*r);
+    for (int i=0;i<n;i+=8) {
+        __m256 px = _mm256_loadu_ps(&b.x[i]), py = _mm256_loadu_ps(&b.y[i]);
+        __m256 hit = _mm256_setzero_ps();
+        for (int k=0;k<nPts;k++) {
+            __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(pts[k].x)), dy = _mm256_sub_ps(py, _mm256_set1_ps(pts[k].y));
+            hit = _mm256_or_ps(hit, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), r2, _CMP_LT_OQ));
+        }
+        unsigned bits = (unsigned)_mm256_movemask_ps(hit);
+        outMask[i >> 6] |= (uint64_t)(bits & ActiveByte(b, i)) << (i & 63);
+    }
+}
+
+__attribute__((target("avx2")))
+static void OverlapPairsAVX2(const BallSoA &b, float dist, std::vector<int> &pairs) {
+    const __m256 d2 = _mm256_set1_ps(dist*dist);
+    for (int i=0;i<b.count;i++) {
+        if (!b.isActive(i)) continue;
+        const __m256 px = _mm256_set1_ps(b.x[i]), py = _mm256_set1_ps(b.y[i]);
+        for (int j=(i+1) & ~7; j<b.count; j+=8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&b.x[j]), px), dy = _mm256_sub_ps(_mm256_loadu_ps(&b.y[j]), py);
+            unsigned bits = (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), d2, _CMP_LT_OQ));
+            bits &= ActiveByte(b, j);
+            if (j <= i) bits &= ~0u << (i + 1 - j);
+            while (bits) { int k = __builtin_ctz(bits); pairs.push_back(i); pairs.push_back(j + k); bits &= bits - 1; }
+        }
+    }
+}
+
+#endif // SOA_X86
+
+static const SoaKernels SCALAR_KERNELS = { KERNEL_SCALAR, "scalar", IntegrateScalar, WithinAnyScalar, OverlapPairsScalar };
+#ifdef SOA_X86
+static const SoaKernels SSE2_KERNELS = { KERNEL_SSE2, "sse2", IntegrateSSE2, WithinAnySSE2, OverlapPairsSSE2 };
+static const SoaKernels AVX2_KERNELS = { KERNEL_AVX2, "avx2", IntegrateAVX2, WithinAnyAVX2, OverlapPairsAVX2 };
+#endif
+
+bool KernelSupported(KernelPath path) {
+#ifdef SOA_X86
+    if (path == KERNEL_AVX2) return __builtin_cpu_supports("avx2");
+    if (path == KERNEL_SSE2) return __builtin_cpu_supports("sse2");
+#endif
+    return path == KERNEL_SCALAR;
+}
+
+const SoaKernels &GetSoaKernels(KernelPath path) {
+#ifdef SOA_X86
+    if (path == KERNEL_AVX2 && KernelSupported(KERNEL_AVX2)) return AVX2_KERNELS;
+    if (path == KERNEL_SSE2 && KernelSupported(KERNEL_SSE2)) return SSE2_KERNELS;
+#endif
+    (void)path;
+    return SCALAR_KERNELS;
+}
+
+const SoaKernels &GetSoaKernels() {
+    static const SoaKernels &best = GetSoaKernels(KernelSupported(KERNEL_AVX2) ? KERNEL_AVX2 : KERNEL_SSE2);
+    return best;
+}
+
+template <typename F>
+static void ForEachBit(const std::vector<uint64_t> &mask, int count, F fn) {
+    for (size_t w=0; w<mask.size(); w++) {
+        uint64_t bits = mask[w];
+        while (bits) {
+            int i = (int)(w*64) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (i < count) fn(i);
+        }
+    }
+}
+
+void StepSoA(BallSoA &b, const TableLayout &L, const SoaKernels &k, std::vector<int> &pocketed) {
+    const Rectangle &play = L.play;
+    const float BALL_R = L.ballR;
+    const TableField &field = *L.field;
+    std::vector<uint64_t> &mask = b.mask;
+    std::vector<int> &pairs = b.pairs;
+    pairs.clear();
+
+    // move balls
+    k.integrate(b, FRICTION, MIN_VEL);
+
+    // ball-ball collisions: the same candidates as step() (closer than four
+    // radii, i < j) into the same solver, working on the lanes in place
+    k.overlapPairs(b, 4.0f*BALL_R, pairs);
+    b.solver.solveStep({ b.x.data(), b.y.data(), b.vx.data(), b.vy.data(), b.count }, pairs, BALL_R);
+
+    // cushion separation & reflect: a gather per ball from the boundary field
+    ForEachBit(b.active, b.count, [&](int i) {
+        float depth; Vector2 n;
+        if (!field.contact({ b.x[i], b.y[i] }, depth, n)) return;
+        b.x[i] += n.x*depth; b.y[i] += n.y*depth;
+        float vdot = b.vx[i]*n.x + b.vy[i]*n.y;
+        if (vdot >= 0.0f) return;
+        b.vx[i] -= 2.0f*vdot*n.x; b.vy[i] -= 2.0f*vdot*n.y;
+        b.vx[i] *= RESTITUTION; b.vy[i] *= RESTITUTION;
+    });
+
+    // pockets detection
+    k.withinAny(b, L.holes, L.config.pockets, L.holeR - 4.0f, mask.data());
+    ForEachBit(mask, b.count, [&](int i) {
+        pocketed.push_back(b.id[i]);
+        if (b.id[i] != 0) { b.setActive(i, false); return; }
+        // cue ball back on the spot, as TableSim::spotCueBall()
+        b.x[i] = play.x + play.width*0.18f; b.y[i] = play.y + play.height*0.5f;
+        b.vx[i] = b.vy[i] = 0.0f;
+    });
+}
@@ -0,0 +1,57 @@
+// Structure-of-arrays ball store plus SIMD step kernels.
+// The best kernel set (AVX2, SSE2 or scalar) is picked at runtime, so one
+// binary runs everywhere; no extra compiler flags are needed.
+
+#ifndef BALL_SOA_H
+#define BALL_SOA_H
+
+#include "table_sim.h"
+#include <cstdint>
+#include <vector>
+
+struct BallSoA {
+    // Lanes are padded to a multiple of SOA_LANES; padding balls sit far off
+    // the table with zero velocity and are never active.
+    std::vector<float> x, y, vx, vy;
+    std::vector<uint64_t> active;   // bit i set = ball i is on the table
+    std::vector<int> id;
+    int count = 0;
+
+    // StepSoA scratch, sized by resize() so stepping never allocates
+    std::vector<uint64_t> mask;
+    std::vector<int> pairs;
+    ContactSolver solver;
+
+    void resize(int n);
+    bool isActive(int i) const { return (active[i >> 6] >> (i & 63)) & 1u; }
+    void setActive(int i, bool on);
+    bool atRest() const;
+    void load(const std::vector<Ball> &balls);
+    void store(std::vector<Ball> &balls) const;
+};
+
+const int SOA_LANES = 8;
+
+enum KernelPath { KERNEL_SCALAR = 0, KERNEL_SSE2 = 1, KERNEL_AVX2 = 2 };
+
+struct SoaKernels {
+    KernelPath path;
+    const char *name;
+    // pos += vel, vel *= friction, each component zeroed below minVel (as step())
+    void (*integrate)(BallSoA &b, float friction, float minVel);
+    // bit i of outMask set when active ball i is closer than r to any of pts
+    void (*withinAny)(const BallSoA &b, const Vector2 *pts, int nPts, float r, uint64_t *outMask);
+    // appends i,j (i < j) for every active pair closer than dist
+    void (*overlapPairs)(const BallSoA &b, float dist, std::vector<int> &pairs);
+};
+
+bool KernelSupported(KernelPath path);
+// best supported path, detected once
+const SoaKernels &GetSoaKernels();
+// a specific path (benchmarks); falls back to scalar when unsupported
+const SoaKernels &GetSoaKernels(KernelPath path);
+
+// One step() worth of physics on SoA storage; pocketed ids are appended.
+void StepSoA(BallSoA &b, const TableLayout &L, const SoaKernels &k, std::vector<int> &pocketed);
+
+#endif
@@ -1,56 +1,31 @@
 // sudo apt install libraylib-dev g++
-// g++ billiard_8ball.cpp -o billiard -lraylib -lm -lpthread -ldl -lrt -lGL
-// ./billiard
+// g++ billiard_8ball.cpp table_sim.cpp contact_solver.cpp table_events.cpp table_query.cpp thread_pool.cpp game_rules.cpp game_snapshot.cpp shot_ai.cpp table_hash.cpp aim_odds.cpp replay.cpp net_play.cpp game_assets.cpp table_draw.cpp input_timeline.cpp profiler.cpp alloc_check.cpp -o billiard -lraylib -lm -lpthread -ldl -lrt -lGL
+// ./billiard [--host [PORT] | --join HOST[:PORT]]
 
 #include "raylib.h"
+#include "table_sim.h"
+#include "table_query.h"
+#include "game_rules.h"
+#include "game_snapshot.h"
+#include "shot_ai.h"
+#include "aim_odds.h"
+#include "replay.h"
+#include "net_play.h"
+#include "game_assets.h"
+#include "table_draw.h"
+#include "input_timeline.h"
+#include "profiler.h"
+#include "alloc_check.h"
 #include <vector>
 #include <cmath>
 #include <string>
 #include <algorithm>
-
-static float clampf_custom(float v, float lo, float hi) { return fmaxf(lo, fminf(v, hi)); }
-static float Dist(const Vector2 &a,const Vector2 &b){ float dx=a.x-b.x, dy=a.y-b.y; return sqrtf(dx*dx+dy*dy); }
-static float Dot(const Vector2 &a,const Vector2 &b){ return a.x*b.x + a.y*b.y; }
-
-struct Segment { Vector2 a,b; };
-
-// Closest point on segment to p
-static Vector2 ClosestPointOnSegment(const Vector2 &a, const Vector2 &b, const Vector2 &p, float &tOut) {
-    Vector2 ab = {b.x-a.x, b.y-a.y};
-    Vector2 ap = {p.x-a.x, p.y-a.y};
-    float ab2 = ab.x*ab.x + ab.y*ab.y;
-    if (ab2 <= 1e-8f) { tOut = 0.0f; return a; }
-    float t = Dot(ap, ab) / ab2;
-    tOut = clampf_custom(t, 0.0f, 1.0f);
-    return { a.x + ab.x * tOut, a.y + ab.y * tOut };
-}
-
-// Ray-ball sampling - returns first hit along ray (step sampling)
-static bool RayBallHit(const Vector2 &rayStart, const Vector2 &dirNorm, const Vector2 &ballPos, float maxDist, float ballRadius, Vector2 &outPoint, float &outDist) {
-    const float step = fmaxf(3.0f, ballRadius * 0.5f);
-    float traveled = 0.0f;
-    while (traveled <= maxDist) {
-        Vector2 p = { rayStart.x + dirNorm.x * traveled, rayStart.y + dirNorm.y * traveled };
-        float d = Dist(p, ballPos);
-        if (d <= ballRadius) { outPoint = p; outDist = traveled; return true; }
-        traveled += step;
-    }
-    return false;
-}
-
-// Ray-segment sampling - detect near-cushion
-static bool RaySegmentHit(const Vector2 &rayStart, const Vector2 &dirNorm, const Segment &seg, float maxDist, float radius, Vector2 &outPoint, float &outDist) {
-    const float step = fmaxf(4.0f, radius * 0.6f);
-    float traveled = 0.0f;
-    while (traveled <= maxDist) {
-        Vector2 p = { rayStart.x + dirNorm.x * traveled, rayStart.y + dirNorm.y * traveled };
-        float t; Vector2 cp = ClosestPointOnSegment(seg.a, seg.b, p, t);
-        float d = Dist(p, cp);
-        if (d <= radius) { outPoint = cp; outDist = traveled; return true; }
-        traveled += step;
-    }
-    return false;
-}
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <future>
+#include <chrono>
 
 static Vector2 Reflect(const Vector2 &v, const Vector2 &n) {
     float vn = v.x*n.x + v.y*n.y;
@@ -70,158 +45,102 @@ static void DrawDashedLine(const Vector2 &a, const Vector2 &b, float dash, float
     }
 }
 
-// ---------------- Ball & collision ----------------
-struct Ball {
-    Vector2 pos;
-    Vector2 vel;
-    bool active;
-    Color color;
-    int id;
+// Per-frame draw accounting. raylib keeps appending quads to one batch until
+// the texture changes (or a render target / blend mode switch flushes it), so
+// every change is one texture bind and one more draw call. The draw code
+// reports each section's texture; shapes share raylib's white texture.
+struct DrawStats {
+    static const unsigned SHAPES = ~0u;
+    int calls = 0, binds = 0;
+    unsigned tex = 0;
+
+    void use(unsigned id) { if (id != tex) { calls++; binds++; tex = id; } }
+    void flush() { tex = 0; }
+    void reset() { calls = binds = 0; tex = 0; }
 };
 
-static void ResolveBallCollision(Ball &A, Ball &B, float r) {
-    if (!A.active || !B.active) return;
-    Vector2 n = { B.pos.x - A.pos.x, B.pos.y - A.pos.y };
-    float d = sqrtf(n.x*n.x + n.y*n.y);
-    if (d <= 1e-6f || d >= 2.0f*r) return;
-    Vector2 norm = { n.x/d, n.y/d };
-    float overlap = 2.0f*r - d;
-    A.pos.x -= norm.x * overlap * 0.5f; A.pos.y -= norm.y * overlap * 0.5f;
-    B.pos.x += norm.x * overlap * 0.5f; B.pos.y += norm.y * overlap * 0.5f;
-    Vector2 rv = { B.vel.x - A.vel.x, B.vel.y - A.vel.y };
-    float velAlongNormal = rv.x*norm.x + rv.y*norm.y;
-    if (velAlongNormal > 0) return;
-    float e = 0.98f;
-    float j = -(1.0f + e) * velAlongNormal;
-    j /= 2.0f;
-    Vector2 imp = { j*norm.x, j*norm.y };
-    A.vel.x -= imp.x; A.vel.y -= imp.y;
-    B.vel.x += imp.x; B.vel.y += imp.y;
-}
-
 // ---------------- Main ----------------
-int main() {
+int main(int argc, char **argv) {
+    // online play: --host waits for a player to --join it and breaks
+    int netSeat = 0;   // 0 plays locally
+    NetLink netLink;
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i], "--host")) {
+            uint16_t port = (i+1 < argc && isdigit((unsigned char)argv[i+1][0])) ? (uint16_t)atoi(argv[++i]) : NET_DEFAULT_PORT;
+            if (!netLink.open(port)) { fprintf(stderr, "cannot listen on UDP port %u\n", (unsigned)port); return 1; }
+            netSeat = 1;
+        } else if (!strcmp(argv[i], "--join") && i+1 < argc) {
+            std::string host = argv[++i];
+            uint16_t port = NET_DEFAULT_PORT;
+            size_t colon = host.rfind(':');
+            if (colon != std::string::npos) { port = (uint16_t)atoi(host.c_str() + colon + 1); host.resize(colon); }
+            if (!netLink.open(0) || !netLink.connect(host.c_str(), port)) { fprintf(stderr, "cannot reach %s:%u\n", host.c_str(), (unsigned)port); return 1; }
+            netSeat = 2;
+        } else {
+            fprintf(stderr, "usage: %s [--host [PORT] | --join HOST[:PORT]]\n", argv[0]);
+            return 1;
+        }
+    }
+    const bool netMode = netSeat != 0;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    auto msSinceStart = [&] { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count(); };
     const int SCREEN_W = 1000;
     const int SCREEN_H = 650;
     InitWindow(SCREEN_W, SCREEN_H, "billiard_8ball (final)");
     SetTargetFPS(60);
 
-    // Table fill most of window - preserve ratio
-    const float TABLE_ASPECT = 840.0f/490.0f;
-    const float PAD = 40.0f;
-    float availW = SCREEN_W - PAD*2;
-    float availH = SCREEN_H - PAD*2;
-    float tableW = availW;
-    float tableH = tableW / TABLE_ASPECT;
-    if (tableH > availH) { tableH = availH; tableW = tableH * TABLE_ASPECT; }
-    Rectangle TABLE = { (SCREEN_W - tableW)/2.0f, (SCREEN_H - tableH)/2.0f, tableW, tableH };
-    const float CUSHION_OFFSET = 14.0f;
-    Rectangle play = { TABLE.x + CUSHION_OFFSET, TABLE.y + CUSHION_OFFSET, TABLE.width - 2.0f*CUSHION_OFFSET, TABLE.height - 2.0f*CUSHION_OFFSET };
-
-    // scale derived
-    float SCALE = TABLE.width / 840.0f;
-    float BALL_R = 12.0f * SCALE;
-    float HOLE_R = 26.0f * SCALE;
-
-    // physics params
-    float FRICTION = 0.992f;
-    const float MIN_VEL = 0.04f;
-
-    // pockets
-    std::vector<Vector2> holes = {
-        { TABLE.x + HOLE_R*0.7f, TABLE.y + HOLE_R*0.7f },
-        { TABLE.x + TABLE.width*0.5f, TABLE.y + HOLE_R*0.7f },
-        { TABLE.x + TABLE.width - HOLE_R*0.7f, TABLE.y + HOLE_R*0.7f },
-        { TABLE.x + HOLE_R*0.7f, TABLE.y + TABLE.height - HOLE_R*0.7f },
-        { TABLE.x + TABLE.width*0.5f, TABLE.y + TABLE.height - HOLE_R*0.7f },
-        { TABLE.x + TABLE.width - HOLE_R*0.7f, TABLE.y + TABLE.height - HOLE_R*0.7f }
-    };
-
-    // Create cushions (segments) with cutouts for pockets (funnel shape)
-    std::vector<Segment> cushions;
-    {
-        float left = play.x;
-        float right = play.x + play.width;
-        float top = play.y;
-        float bot = play.y + play.height;
-        float cut = HOLE_R * 1.2f;
-
-        float pk0x = holes[0].x;
-        float pk1x = holes[1].x;
-        float pk2x = holes[2].x;
-        // between top-left and top-mid
-        cushions.push_back({ { pk0x + cut, top }, { pk1x - cut, top }});
-        cushions.push_back({ { pk1x + cut, top }, { pk2x - cut, top }});
-
-        // bottom rails mirrored
-        float pk3x = holes[3].x;
-        float pk4x = holes[4].x;
-        float pk5x = holes[5].x;
-        cushions.push_back({ { pk3x + cut, bot }, { pk4x - cut, bot }});
-        cushions.push_back({ { pk4x + cut, bot }, { pk5x - cut, bot }});
-    }
-
-    // load assets from assets/
+    TableSim sim(MakeTableLayout(SCREEN_W, SCREEN_H));
+    const Rectangle &TABLE = sim.layout.table;
+    const float SCALE = sim.layout.scale;
+    const float BALL_R = sim.layout.ballR;
+    const float HOLE_R = sim.layout.holeR;
+    const Vector2 (&holes)[6] = sim.layout.holes;
+    const std::vector<Segment> &cushions = sim.layout.cushions;
+    std::vector<Ball> &balls = sim.balls;
+
+    // Assets decode on a worker (assets/assets.bundle when present, else the
+    // PNG/TTF sources) while the main thread keeps presenting a loading
+    // screen; only the GPU uploads happen here once the worker is done.
     std::string baseDir = "assets/";
-    Texture2D ballTex[16];
-    for (int i=0;i<16;i++) ballTex[i] = {0,0,0,0};
-    Texture2D cueTex = {0,0,0,0};
-    Font customFont = {0};
-    bool texturesOK = true;
-    for (int i=0;i<16;i++) {
-        std::string fn = baseDir + "ball" + std::to_string(i) + ".png";
-        // attempt load (if missing, raylib loads id==0)
-        ballTex[i] = LoadTexture(fn.c_str());
+    DecodedAssets decoded;
+    std::future<void> assetJob = std::async(std::launch::async, [&] { DecodeAssets(baseDir, decoded); });
+    double firstFrameMs = -1.0;
+    while (assetJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (WindowShouldClose()) { assetJob.wait(); CloseWindow(); return 0; }
+        BeginDrawing();
+        ClearBackground(DARKGREEN);
+        DrawText("Loading...", SCREEN_W/2 - 70, SCREEN_H/2 - 14, 28, RAYWHITE);
+        EndDrawing();
+        if (firstFrameMs < 0.0) firstFrameMs = msSinceStart();
     }
-    cueTex = LoadTexture((baseDir + "cue.png").c_str());
-    customFont = LoadFont((baseDir + "Purisa-BoldOblique.ttf").c_str());
-    bool anyBallTex=false;
-    for (int i=0;i<16;i++) if (ballTex[i].id != 0) anyBallTex=true;
+    GameAssets assets = UploadAssets(decoded);
+    decoded.release();
+    const double assetsReadyMs = msSinceStart();
+    if (firstFrameMs < 0.0) firstFrameMs = assetsReadyMs;
+    TraceLog(LOG_INFO, "STARTUP: first frame %.1f ms, assets ready %.1f ms (%s decoded in %.1f ms)",
+             firstFrameMs, assetsReadyMs, decoded.fromBundle ? "bundle" : "sources", decoded.decodeMs);
+
+    Texture2D &ballAtlas = assets.ballAtlas;
+    const Rectangle (&ballSrc)[16] = assets.ballSrc;
+    const bool (&ballHas)[16] = assets.ballHas;
+    Texture2D &cueTex = assets.cue;
+    Font &customFont = assets.font;
+    bool texturesOK = true;
+    bool anyBallTex = ballAtlas.id != 0;
     if (!(anyBallTex && cueTex.id != 0 && customFont.texture.id != 0)) texturesOK=false;
 
-    auto colorForId = [&](int id)->Color {
-        if (id==0) return WHITE;
-        if (id==8) return BLACK;
-        Color cs[] = { RED, ORANGE, GOLD, BLUE, PURPLE, DARKGREEN, MAROON };
-        if (id>=1 && id<=7) return cs[id-1];
-        if (id>=9 && id<=15) return cs[(id-9)%7];
-        return WHITE;
-    };
-
-    // initialize balls: cue on left, rack right
-    auto initBalls = [&]()->std::vector<Ball>{
-        std::vector<Ball> v;
-        v.reserve(16);
-        v.push_back({ { play.x + play.width*0.18f, play.y + play.height*0.5f }, {0,0}, true, WHITE, 0 });
-        // rack 15
-        Vector2 rackTip = { play.x + play.width*0.72f, play.y + play.height*0.5f };
-        float sep = (BALL_R*2.0f) + (1.5f * SCALE);
-        std::vector<Vector2> pos;
-        for (int r=0;r<5;r++){
-            float x = rackTip.x + r*sep;
-            float y = rackTip.y - (r*sep)/2.0f;
-            for (int i=0;i<=r;i++) pos.push_back({ x, y + i*sep });
-        }
-        std::vector<int> order = { 1, 15, 2, 9, 8, 3, 10, 4, 11, 5, 12, 6, 13, 7, 14 };
-        for (int i=0;i<15;i++){
-            int id = order[i];
-            v.push_back({ pos[i], {0,0}, true, colorForId(id), id });
-        }
-        return v;
-    };
-
-    std::vector<Ball> balls = initBalls();
-
-    // game state
-    int currentPlayer = 1;
-    int score[3] = {0,0,0};
-    bool waitingPlacement = false;
-    bool shotInProgress = false;
+    // game state (the rules-driven part lives in turn, see game_rules.h)
+    TurnState turn;
+    int &currentPlayer = turn.currentPlayer;
+    int (&score)[3] = turn.score;
+    bool &waitingPlacement = turn.waitingPlacement;
+    bool &shotInProgress = turn.shotInProgress;
     bool charging = false;
     float power = 0.0f;
-    const float MAX_POWER = 20.0f;
-    bool gameOver = false;
-    int winner = -1;
+    double chargeStartMs = 0.0;   // power is the time held since then
+    bool &gameOver = turn.gameOver;
+    int &winner = turn.winner;
 
     enum GameState { MENU = 0, PLAY = 1, STOPPED = 2 };
     GameState state = MENU;
@@ -231,9 +150,127 @@ int main() {
     Rectangle btnStop = { SCREEN_W - 150.0f, SCREEN_H - 60.0f, 130.0f, 44.0f };
 
     int ignoreInputFramesAfterStart = 0;
-    const float SLOW_THRESHOLD = 0.08f; // very slow threshold (for early end)
-    const float SLOW_DURATION = 0.35f;
-    float slowTimer = 0.0f;
+    float &slowTimer = turn.slowTimer;
+
+    // fixed-timestep physics, rendered interpolated between the last two ticks
+    const float MAX_FRAME_DT = 0.25f;    // drop time after a stall instead of spiralling
+    float physicsAccum = 0.0f;
+    std::vector<Vector2> prevPos(balls.size());
+    for (size_t i=0;i<balls.size();++i) prevPos[i] = balls[i].pos;
+
+    // cached frame for idle elision
+    RenderTexture2D frameCache = LoadRenderTexture(SCREEN_W, SCREEN_H);
+    float lastSceneKey[14] = { 0 };
+    bool frameCached = false;
+    bool waitingEvents = false;
+
+    // Static table (rails, cloth, pockets, cushions) baked once into its own
+    // layer; rebuilt only when the table geometry changes.
+    RenderTexture2D tableLayer = LoadRenderTexture(SCREEN_W, SCREEN_H);
+    float lastLayerKey[7] = { 0 };
+    bool layerBuilt = false;
+
+    // F2 shows draw calls / texture binds for the last presented frame and
+    // for the last scene redraw (the frames that actually cost something)
+    DrawStats frameStats, sceneStats, shownFrameStats;
+    bool showDrawStats = false;
+
+#ifdef BILLIARD_PROFILE
+    // F3 shows per-phase timings for the last PROFILE_RING frames; the ring
+    // is written to profile.csv / profile.json on exit
+    ProfileAttachThread();
+    bool showProfile = false;
+#endif
+#ifdef BILLIARD_ALLOC_CHECK
+    // every heap allocation any thread makes in a steady-state frame is
+    // logged, and the exit status says whether there were any
+    long steadyAllocs = 0;
+#endif
+
+    // computer opponent (C toggles): player 2 searches on a background thread
+    // against a snapshot of the table, leaving a core free for this loop
+    bool vsComputer = false;
+    auto aiTurn = [&] { return vsComputer && currentPlayer == 2; };
+    ThreadPool aiPool(std::max(1, (int)std::thread::hardware_concurrency() - 1));
+    // outcomes survive between searches: a table seen again (undo, a restarted
+    // search) is mostly lookups, so the time budget reaches further
+    ShotCache aiCache;
+    AiConfig aiConfig;
+    aiConfig.cache = &aiCache;
+    ShotSearchWorker aiSearch(sim.layout, aiPool, aiConfig);
+    AiShot aiShot;
+
+    // every game is recorded; finished or abandoned ones land in REPLAY_PATH
+    // (play back with billiard_sim --replay)
+    const char *REPLAY_PATH = "last_game.8br";
+    ReplayRecorder replay;
+    uint32_t physTick = 0;
+    auto saveReplay = [&] {
+        if (replay.recording() && replay.shots() > 0) SaveReplay(REPLAY_PATH, replay.finish(physTick, sim, turn));
+    };
+
+    // online, the session ticks the table and carries this side's inputs;
+    // the mouse only plays on our own turns
+    NetSession net(netLink, netMode ? netSeat : 1, sim, turn, GAME_SUBSTEPS, &replay);
+    auto localTurn = [&] { return netMode ? net.localTurn() : !aiTurn(); };
+    auto turnTag = [&] { return aiTurn() ? " (CPU)" : !netMode ? "" : currentPlayer == netSeat ? " (you)" : " (remote)"; };
+
+    // pocket odds for the current aim, sampled on a worker thread; before the
+    // mouse is pressed they are shown for a half-power shot
+    AimOddsWorker aimOdds(sim.layout);
+    const float ODDS_IDLE_POWER = MAX_POWER * 0.5f;
+
+    // U takes back the last shot, up to UNDO_SHOTS of them: table, turn and
+    // physics tick come back from a snapshot taken as it was played, and the
+    // replay drops everything recorded since
+    struct UndoEntry { GameSnapshot game; ReplayMark replay; };
+    const int UNDO_SHOTS = 16;
+    UndoRing<UndoEntry, UNDO_SHOTS> undo;
+    auto pushUndo = [&] {
+        UndoEntry e;
+        if (!SaveSnapshot(sim, turn, physTick, e.game)) return;
+        e.replay = replay.mark();
+        undo.push(e);
+    };
+
+    // Start, Stop and R all come here: a fresh rack, with a new recording
+    // when next is PLAY
+    auto resetGame = [&](GameState next) {
+        saveReplay();
+        state = next;
+        NewGame(sim, turn);
+        physTick = 0;
+        if (next == PLAY) replay.begin(sim, GAME_SUBSTEPS);
+        charging = false;
+        power = 0.0f;
+        physicsAccum = 0.0f;
+        for (size_t i=0;i<balls.size();++i) prevPos[i] = balls[i].pos;
+        aiSearch.cancel();
+        undo.clear();
+    };
+
+    // Input goes through a timeline of timestamped polls. While the local
+    // player can shoot and the loop is not blocked on events, frames are
+    // paced here instead of in EndDrawing and the mouse is polled every
+    // INPUT_SAMPLE_MS in between, so a shot takes its power and angle from
+    // the moment of release rather than from the frame that noticed it.
+    const double FRAME_MS = 1000.0 / 60.0;
+    InputTimeline input;
+    auto pollInput = [&] {
+        input.sample(msSinceStart(), GetMousePosition(), IsMouseButtonDown(MOUSE_LEFT_BUTTON));
+        for (int k; (k = GetKeyPressed()) != 0; ) input.key(k);
+    };
+    bool fastInput = false;
+    double lastFrameStartMs = msSinceStart();
+    pollInput();
+
+    // F4 shows input latency: release to shot applied, release to the first
+    // presented frame with the ball moving, and mouse poll to the presented
+    // aim. Presented means EndDrawing returned; the display adds its own delay.
+    LatencyTrack releaseToShot, releaseToPhoton, mouseToPhoton;
+    double photonFromMs = -1.0;   // a shot's release, until a frame shows it moving
+    uint32_t photonTick = 0;
+    bool showLatency = false;
 
     // configure text sizes (mixed => D)
     int titleSize = 48;
@@ -243,41 +280,80 @@ int main() {
 
     // main loop
     while (!WindowShouldClose()) {
-        float dt = GetFrameTime();
-        Vector2 mouse = GetMousePosition();
+        PROFILE_BEGIN(inputStart);
+#ifdef BILLIARD_ALLOC_CHECK
+        const long allocsAtFrameStart = AllocCount();
+        const GameState stateAtFrameStart = state;
+        const uint32_t tickAtFrameStart = physTick;
+#endif
+        const double frameStartMs = msSinceStart();
+        // raylib's frame time leaves out waits it did not do itself
+        float dt = fastInput ? (float)((frameStartMs - lastFrameStartMs) / 1000.0) : GetFrameTime();
+        lastFrameStartMs = frameStartMs;
+        input.beginFrame();
+        Vector2 mouse = input.mouse();
+        const double mouseMs = input.mouseMs();
+
+        // keys from every poll since the last frame
+        if (input.keyPressed(KEY_C) && !netMode) {
+            vsComputer = !vsComputer;
+            aiSearch.cancel();   // a search from before is for another table
+        }
+        if (input.keyPressed(KEY_F2)) showDrawStats = !showDrawStats;
+#ifdef BILLIARD_PROFILE
+        if (input.keyPressed(KEY_F3)) showProfile = !showProfile;
+#endif
+        if (input.keyPressed(KEY_F4)) showLatency = !showLatency;
+
+        // restart quick R
+        if (input.keyPressed(KEY_R) && !netMode) {
+            resetGame(PLAY);
+        }
+
+        // undo: against the computer, back to the human's last shot
+        if (input.keyPressed(KEY_U) && state != MENU && !charging && !netMode) {
+            // the newest entry to go back to; none left of the human's turns
+            // (the ring dropped them) means there is nothing to undo
+            int back = 0;
+            while (vsComputer && back < undo.size() && undo.peek(back).game.turn.currentPlayer != 1) back++;
+            if (back < undo.size()) {
+                UndoEntry e;
+                for (int i=0;i<=back;i++) undo.pop(e);
+                aiSearch.cancel();
+                RestoreSnapshot(e.game, sim, turn);
+                physTick = e.game.tick;
+                replay.rewind(e.replay);
+                state = PLAY;
+                physicsAccum = 0.0f;
+                for (size_t i=0;i<balls.size();++i) prevPos[i] = balls[i].pos;
+                frameCached = false;
+            }
+        }
+
+
+        // online: the game starts as soon as the other side answers
+        if (netMode) {
+            net.update(GetTime() * 1000.0);
+            if (state == MENU && net.connected()) {
+                resetGame(PLAY);
+                net.begin();
+            }
+            physTick = net.tick();
+            // a late shot from the other side can end the game during rollback
+            if (state == PLAY && gameOver) { state = STOPPED; saveReplay(); }
+        }
 
         // handle Start/Stop clicks
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+        if (input.pressed() && !netMode) {
             if (state == MENU || state == STOPPED) {
                 if (CheckCollisionPointRec(mouse, btnStart)) {
-                    // start
-                    state = PLAY;
-                    balls = initBalls();
-                    score[1] = score[2] = 0;
-                    currentPlayer = 1;
-                    waitingPlacement = false;
-                    shotInProgress = false;
-                    charging = false;
-                    power = 0.0f;
-                    gameOver = false;
-                    winner = -1;
+                    resetGame(PLAY);
                     ignoreInputFramesAfterStart = 6; // small grace
-                    slowTimer = 0.0f;
                 }
             } else if (state == PLAY) {
                 if (CheckCollisionPointRec(mouse, btnStop)) {
                     // stop => back to menu
-                    state = MENU;
-                    balls = initBalls();
-                    score[1] = score[2] = 0;
-                    currentPlayer = 1;
-                    waitingPlacement = false;
-                    shotInProgress = false;
-                    charging = false;
-                    power = 0.0f;
-                    gameOver = false;
-                    winner = -1;
-                    slowTimer = 0.0f;
+                    resetGame(MENU);
                 }
             }
         }
@@ -287,355 +363,481 @@ int main() {
             if (ignoreInputFramesAfterStart > 0) ignoreInputFramesAfterStart--;
 
             Vector2 cuePos = balls[0].pos;
-            float aimAngle = atan2f(mouse.y - cuePos.y, mouse.x - cuePos.x);
 
             // ball-in-hand placement
-            if (waitingPlacement && IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && ignoreInputFramesAfterStart == 0) {
-                Vector2 p = mouse;
-                p.x = clampf_custom(p.x, play.x + BALL_R, play.x + play.width - BALL_R);
-                p.y = clampf_custom(p.y, play.y + BALL_R, play.y + play.height - BALL_R);
-                bool ok = true;
-                for (size_t i=1;i<balls.size();++i) if (balls[i].active && Dist(p, balls[i].pos) < 2.0f*BALL_R + 1.0f) ok = false;
-                if (ok) { balls[0].pos = p; balls[0].vel = {0,0}; waitingPlacement = false; }
+            if (localTurn() && waitingPlacement && input.pressed() && ignoreInputFramesAfterStart == 0) {
+                if (netMode) net.place(mouse);
+                else if (sim.placeCueBall(mouse)) { waitingPlacement = false; replay.place(physTick, mouse); }
             }
 
-            // shooting input
-            if (ignoreInputFramesAfterStart == 0 && !shotInProgress && !waitingPlacement) {
-                if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+            // shooting input: power charges with the time held
+            if (localTurn() && ignoreInputFramesAfterStart == 0 && !shotInProgress && !waitingPlacement) {
+                if ((input.down() || input.pressed()) && !charging) {
                     charging = true;
-                    power += 0.45f;
-                    if (power > MAX_POWER) power = MAX_POWER;
+                    chargeStartMs = input.pressed() ? input.pressMs() : input.mouseMs();
                 }
-                if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON) && charging) {
-                    balls[0].vel.x = cosf(aimAngle) * (-power);
-                    balls[0].vel.y = sinf(aimAngle) * (-power);
-                    shotInProgress = true;
+                if (charging) power = ChargePower(input.mouseMs() - chargeStartMs);
+                if (input.released() && charging) {
+                    // as of the poll that saw the release, not this frame
+                    float shotPower = ChargePower(input.releaseMs() - chargeStartMs);
+                    Vector2 at = input.releaseMouse();
+                    float shotAngle = atan2f(at.y - cuePos.y, at.x - cuePos.x);
+                    if (netMode) {
+                        net.shoot(shotAngle, shotPower);   // applies before the next tick
+                    } else {
+                        pushUndo();
+                        replay.shot(physTick, sim, turn, shotAngle, shotPower);
+                        sim.shoot(shotAngle, shotPower);
+                        shotInProgress = true;
+                        slowTimer = 0.0f;
+                    }
+                    releaseToShot.add((float)(msSinceStart() - input.releaseMs()));
+                    photonFromMs = input.releaseMs();
+                    photonTick = physTick;
                     charging = false;
                     power = 0.0f;
-                    slowTimer = 0.0f;
-                }
-            }
-
-            // move balls
-            for (auto &b : balls) {
-                if (!b.active) continue;
-                b.pos.x += b.vel.x;
-                b.pos.y += b.vel.y;
-                b.vel.x *= FRICTION;
-                b.vel.y *= FRICTION;
-                if (fabs(b.vel.x) < MIN_VEL) b.vel.x = 0.0f;
-                if (fabs(b.vel.y) < MIN_VEL) b.vel.y = 0.0f;
-
-                // near pocket
-                bool nearPocket=false;
-                for (auto &h: holes) if (Dist(b.pos,h) < HOLE_R + BALL_R + 8.0f) nearPocket=true;
-
-                if (!nearPocket) {
-                    if (b.pos.x < play.x) { b.pos.x = play.x; b.vel.x *= -1.0f; }
-                    if (b.pos.x > play.x + play.width) { b.pos.x = play.x + play.width; b.vel.x *= -1.0f; }
-                    if (b.pos.y < play.y) { b.pos.y = play.y; b.vel.y *= -1.0f; }
-                    if (b.pos.y > play.y + play.height) { b.pos.y = play.y + play.height; b.vel.y *= -1.0f; }
                 }
             }
 
-            // ball-ball collisions
-            for (size_t i=0;i<balls.size();++i)
-                for (size_t j=i+1;j<balls.size();++j)
-                    ResolveBallCollision(balls[i], balls[j], BALL_R);
-
-            // cushion separation & reflect
-            for (auto &seg : cushions) {
-                for (auto &b : balls) {
-                    if (!b.active) continue;
-                    float t; Vector2 cp = ClosestPointOnSegment(seg.a, seg.b, b.pos, t);
-                    float d = Dist(cp, b.pos);
-                    if (d < BALL_R) {
-                        Vector2 n = { b.pos.x - cp.x, b.pos.y - cp.y };
-                        float nlen = sqrtf(n.x*n.x + n.y*n.y);
-                        if (nlen < 1e-6f) continue;
-                        Vector2 n_norm = { n.x/nlen, n.y/nlen };
-                        float overlap = BALL_R - d;
-                        b.pos.x += n_norm.x * overlap;
-                        b.pos.y += n_norm.y * overlap;
-                        float vdot = b.vel.x*n_norm.x + b.vel.y*n_norm.y;
-                        b.vel.x -= 2.0f * vdot * n_norm.x;
-                        b.vel.y -= 2.0f * vdot * n_norm.y;
-                        b.vel.x *= 0.98f; b.vel.y *= 0.98f;
-                    }
+            // computer turn: place if needed, start a search, shoot once it answers
+            if (aiTurn() && ignoreInputFramesAfterStart == 0 && !shotInProgress) {
+                if (waitingPlacement) {
+                    Vector2 spot = ChooseCuePlacement(sim);
+                    if (sim.placeCueBall(spot)) replay.place(physTick, spot);
+                    else { sim.spotCueBall(); replay.spot(physTick); }
+                    waitingPlacement = false;
+                } else if (!aiSearch.pending()) {
+                    aiSearch.start(sim);
+                } else if (aiSearch.take(sim, aiShot)) {
+                    pushUndo();
+                    replay.shot(physTick, sim, turn, aiShot.angle, aiShot.power);
+                    sim.shoot(aiShot.angle, aiShot.power);
+                    shotInProgress = true;
+                    slowTimer = 0.0f;
                 }
             }
+        } // end PLAY input
+        PROFILE_END(inputStart, PROF_INPUT);
 
-            // pockets detection
-            std::vector<int> pocketed;
-            for (auto &b : balls) {
-                if (!b.active) continue;
-                for (auto &h: holes) {
-                    if (Dist(b.pos,h) < HOLE_R - 4.0f) {
-                        pocketed.push_back(b.id);
-                        if (b.id != 0) b.active = false;
-                        // cue ball handled later (ball-in-hand)
-                    }
+        if (state == PLAY && !gameOver) {
+            PROFILE_SCOPE(PROF_PHYSICS);
+            // Fixed-timestep physics: whatever the render rate, the table advances
+            // in GAME_TICK_DT ticks of one 60 Hz frame each, split into GAME_SUBSTEPS.
+            // Collisions, cushions and pockets are resolved at their exact time
+            // of impact, so substeps only set how often the rules below look at
+            // the table; fewer substeps never change where the balls go.
+            physicsAccum += fminf(dt, MAX_FRAME_DT);
+            while (physicsAccum >= GAME_TICK_DT && !gameOver) {
+                physicsAccum -= GAME_TICK_DT;
+                for (size_t i=0;i<balls.size();++i) prevPos[i] = balls[i].pos;
+
+                if (netMode) {
+                    net.stepTick();
+                    physTick = net.tick();
+                } else {
+                    RulesTick(sim, turn, GAME_SUBSTEPS, GAME_TICK_DT);
+                    physTick++;
                 }
+                if (gameOver) { state = STOPPED; saveReplay(); }
             }
-
-            bool foul=false, scoredBall=false, pocket8=false;
-            for (int id : pocketed) {
-                if (id==0) foul=true;
-                else if (id==8) pocket8=true;
-                else { score[currentPlayer]++; scoredBall=true; }
-            }
-            if (foul) {
-                score[currentPlayer] = std::max(0, score[currentPlayer]-1);
-                balls[0].pos = { play.x + play.width*0.18f, play.y + play.height*0.5f };
-                balls[0].vel = {0,0};
-                currentPlayer = (currentPlayer==1?2:1);
-                waitingPlacement = true;
-                shotInProgress = false;
-            }
-            if (pocket8) { winner = currentPlayer; gameOver = true; state = STOPPED; }
-
-            // early turn end detection
-            bool allVerySlow=true;
-            for (auto &b: balls) {
-                if (!b.active) continue;
-                float speed = sqrtf(b.vel.x*b.vel.x + b.vel.y*b.vel.y);
-                if (speed > SLOW_THRESHOLD) { allVerySlow=false; break; }
-            }
-            if (allVerySlow && shotInProgress) slowTimer += dt; else slowTimer = 0.0f;
-            if (slowTimer >= SLOW_DURATION && shotInProgress) {
-                if (!foul && !scoredBall) currentPlayer = (currentPlayer==1?2:1);
-                shotInProgress = false;
-                slowTimer = 0.0f;
-            }
-
-        } // end PLAY update
+        } // end PLAY physics
 
         // ---------------- DRAW ----------------
-        BeginDrawing();
-        ClearBackground(DARKGREEN);
-
-        // draw rails (wood)
-        DrawRectangle((int)(TABLE.x - 35), (int)(TABLE.y - 35), (int)(TABLE.width + 70), 35, (Color){80,40,10,255});
-        DrawRectangle((int)(TABLE.x - 35), (int)(TABLE.y + TABLE.height), (int)(TABLE.width + 70), 35, (Color){80,40,10,255});
-        DrawRectangle((int)(TABLE.x - 35), (int)(TABLE.y - 35), 35, (int)(TABLE.height + 70), (Color){80,40,10,255});
-        DrawRectangle((int)(TABLE.x + TABLE.width), (int)(TABLE.y - 35), 35, (int)(TABLE.height + 70), (Color){80,40,10,255});
-
-        // draw play cloth and subtle texture stripes
-        Color cloth = {10,120,60,255};
-        DrawRectangleRec(play, cloth);
-        for (int y=(int)play.y; y < (int)(play.y + play.height); y += 6) DrawLine((int)play.x, y, (int)(play.x + play.width), y, (Color){0,60,30,18});
-
-        // draw pockets (funnel mouth) - black circles then a darker inner fade
-        for (auto &h : holes) {
-            DrawCircleV(h, HOLE_R, BLACK);
-            DrawCircleV(h, HOLE_R*0.7f, (Color){0,0,0,200});
+        // The scene is drawn into frameCache and only redrawn when something
+        // visible changed; an idle table just re-presents the cached frame.
+        bool aimVisible = (state == PLAY && !shotInProgress && !waitingPlacement && ignoreInputFramesAfterStart == 0 && !gameOver && localTurn());
+        AimOdds odds;
+        if (aimVisible && sim.sleeping) {
+            float angle = atan2f(mouse.y - balls[0].pos.y, mouse.x - balls[0].pos.x);
+            aimOdds.aim(balls, angle, charging ? power : ODDS_IDLE_POWER);
+            odds = aimOdds.latest();
+        } else {
+            aimOdds.cancel();
         }
-
-        // draw cushions (no green pocket lines)
-        for (auto &s : cushions) DrawLineEx(s.a, s.b, 6.0f * SCALE, (Color){18,80,20,200});
-
-        // draw balls (textures centered if loaded)
-        bool texOK = (ballTex[0].id != 0 && cueTex.id != 0 && customFont.texture.id != 0);
-        for (auto &b : balls) {
-            if (!b.active) continue;
-            if (texOK && ballTex[b.id].id != 0) {
-                Texture2D &tx = ballTex[b.id];
-                Rectangle src = { 0, 0, (float)tx.width, (float)tx.height };
-                Rectangle dst = { b.pos.x - BALL_R, b.pos.y - BALL_R, BALL_R*2.0f, BALL_R*2.0f };
-                Vector2 origin = { BALL_R, BALL_R };
-                DrawTexturePro(tx, src, dst, origin, 0.0f, WHITE);
-            } else {
-                // fallback
-                DrawCircleV(b.pos, BALL_R, b.color);
-                DrawCircleV({ b.pos.x - BALL_R*0.35f, b.pos.y - BALL_R*0.35f }, BALL_R*0.34f, (Color){255,255,255,80});
-                DrawCircleV(b.pos, BALL_R*0.56f, WHITE);
-                DrawText(TextFormat("%d", b.id), (int)(b.pos.x - BALL_R*0.35f), (int)(b.pos.y - BALL_R*0.55f), (int)BALL_R, BLACK);
-                if (b.id >= 9 && b.id <= 15) DrawRectangle((int)(b.pos.x - BALL_R), (int)(b.pos.y - BALL_R*0.45f), (int)(BALL_R*2.0f), (int)(BALL_R*0.9f), WHITE);
-            }
+        float sceneKey[14] = { (float)state, (float)currentPlayer, (float)score[1], (float)score[2], (float)winner, power,
+                               (float)waitingPlacement, (float)shotInProgress, (float)gameOver, (float)ignoreInputFramesAfterStart,
+                               aimVisible ? mouse.x : 0.0f, aimVisible ? mouse.y : 0.0f, (float)vsComputer, (float)odds.samples };
+        bool tableStill = (state != PLAY || sim.sleeping);
+        bool redraw = !frameCached || !tableStill || memcmp(sceneKey, lastSceneKey, sizeof(sceneKey)) != 0;
+        frameStats.reset();
+        float layerKey[7] = { TABLE.x, TABLE.y, TABLE.width, TABLE.height, SCALE, HOLE_R, (float)cushions.size() };
+        if (!layerBuilt || memcmp(layerKey, lastLayerKey, sizeof(layerKey)) != 0) {
+            PROFILE_SCOPE(PROF_DRAW_TABLE);
+            BeginTextureMode(tableLayer);
+            ClearBackground(DARKGREEN);
+            DrawTableBackground(sim.layout, TableView());
+            EndTextureMode();
+            memcpy(lastLayerKey, layerKey, sizeof(layerKey));
+            layerBuilt = true;
+            redraw = true;
         }
 
-        // draw cue and trajectory only in PLAY and when not shot and not waitingPlacement and not ignoring start frames
-        if (state == PLAY && !shotInProgress && !waitingPlacement && ignoreInputFramesAfterStart == 0 && !gameOver) {
-            Vector2 cuePos = balls[0].pos;
-            Vector2 mousePos = GetMousePosition();
-            float angle = atan2f(mousePos.y - cuePos.y, mousePos.x - cuePos.x);
-
-            // draw cue: user's texture has tip on RIGHT
-            if (cueTex.id != 0) {
-                Texture2D &tx = cueTex;
-                Rectangle src = { (float)tx.width, 0.0f, -(float)tx.width, (float)tx.height };
-                float desiredLen = 180.0f * SCALE;
-                float scaleX = desiredLen / (float)tx.width;
-                float scaleY = (desiredLen / (float)tx.width);
-                Rectangle dst = { cuePos.x - desiredLen*0.08f, cuePos.y - (float)tx.height*scaleY/2.0f, desiredLen, (float)tx.height*scaleY };
-                Vector2 origin = { desiredLen*0.08f, (float)tx.height*scaleY/2.0f };
-                DrawTexturePro(tx, src, dst, origin, angle*RAD2DEG, WHITE);
-            } else {
-                // fallback simple line
-                Vector2 butt = cuePos;
-                Vector2 tip = { cuePos.x + cosf(angle)*(180.0f*SCALE), cuePos.y + sinf(angle)*(180.0f*SCALE) };
-                DrawLineEx(butt, tip, 10.0f*SCALE, (Color){181,101,29,255});
-            }
-
-            // TRAJECTORY: starts BEHIND cue ball
-            Vector2 dirBack = { -cosf(angle), -sinf(angle) };
-            Vector2 startTrace = { cuePos.x + dirBack.x * (BALL_R + 2.0f), cuePos.y + dirBack.y * (BALL_R + 2.0f) };
-            const float MAX_TRACE = 1200.0f;
-
-            // check pocket first
-            float bestDist = 1e9f;
-            Vector2 bestHit = { startTrace.x + dirBack.x * MAX_TRACE, startTrace.y + dirBack.y * MAX_TRACE };
-            enum { NONE=0, HIT_BALL=1, HIT_CUSHION=2, HIT_POCKET=3 } hitType = NONE;
-            Segment hitSeg;
-
-            // check pockets
-            for (auto &h : holes) {
-                // project the vector
-                Vector2 toHole = { h.x - startTrace.x, h.y - startTrace.y };
-                float proj = toHole.x*dirBack.x + toHole.y*dirBack.y;
-                if (proj < 0 || proj > MAX_TRACE) continue;
-                // perpendicular distance
-                Vector2 closest = { startTrace.x + dirBack.x * proj, startTrace.y + dirBack.y * proj };
-                float perp = Dist(closest, h);
-                if (perp <= HOLE_R) {
-                    if (proj < bestDist) { bestDist = proj; bestHit = closest; hitType = HIT_POCKET; }
+        if (redraw) {
+            PROFILE_BEGIN(tableStart);
+            BeginTextureMode(frameCache);
+            frameStats.flush();
+            // the baked table, colour copied straight over like the frame cache below
+            ClearBackground(BLACK);
+            BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+            frameStats.use(tableLayer.texture.id);
+            DrawTextureRec(tableLayer.texture, { 0, 0, (float)SCREEN_W, -(float)SCREEN_H }, { 0, 0 }, WHITE);
+            EndBlendMode();
+            frameStats.flush();
+            PROFILE_END(tableStart, PROF_DRAW_TABLE);
+
+            // draw balls (textures centered if loaded)
+            PROFILE_BEGIN(ballsStart);
+            bool texOK = (ballHas[0] && cueTex.id != 0 && customFont.texture.id != 0);
+            const unsigned fontTex = GetFontDefault().texture.id;
+            // positions blended between the last two physics ticks; jumps (cue ball
+            // re-spotted or placed) are drawn where they landed
+            float alpha = (state == PLAY) ? physicsAccum / GAME_TICK_DT : 1.0f;
+            for (size_t i=0;i<balls.size();++i) {
+                Ball b = balls[i];
+                if (!b.active) continue;
+                if (Dist(prevPos[i], b.pos) < 4.0f*BALL_R) {
+                    b.pos.x = prevPos[i].x + (b.pos.x - prevPos[i].x) * alpha;
+                    b.pos.y = prevPos[i].y + (b.pos.y - prevPos[i].y) * alpha;
+                }
+                if (texOK && ballHas[b.id]) {
+                    frameStats.use(ballAtlas.id);
+                    Rectangle src = ballSrc[b.id];
+                    Rectangle dst = { b.pos.x - BALL_R, b.pos.y - BALL_R, BALL_R*2.0f, BALL_R*2.0f };
+                    Vector2 origin = { BALL_R, BALL_R };
+                    DrawTexturePro(ballAtlas, src, dst, origin, 0.0f, WHITE);
+                } else {
+                    // fallback
+                    frameStats.use(DrawStats::SHAPES);
+                    DrawCircleV(b.pos, BALL_R, BallColor(b.id));
+                    DrawCircleV({ b.pos.x - BALL_R*0.35f, b.pos.y - BALL_R*0.35f }, BALL_R*0.34f, (Color){255,255,255,80});
+                    DrawCircleV(b.pos, BALL_R*0.56f, WHITE);
+                    frameStats.use(fontTex);
+                    DrawText(TextFormat("%d", b.id), (int)(b.pos.x - BALL_R*0.35f), (int)(b.pos.y - BALL_R*0.55f), (int)BALL_R, BLACK);
+                    if (b.id >= 9 && b.id <= 15) frameStats.use(DrawStats::SHAPES);
+                    if (b.id >= 9 && b.id <= 15) DrawRectangle((int)(b.pos.x - BALL_R), (int)(b.pos.y - BALL_R*0.45f), (int)(BALL_R*2.0f), (int)(BALL_R*0.9f), WHITE);
                 }
             }
+            PROFILE_END(ballsStart, PROF_DRAW_BALLS);
+
+            // draw cue and trajectory only in PLAY and when not shot and not waitingPlacement not ignoring start frames and not the computer's turn
+            if (aimVisible) {
+                PROFILE_SCOPE(PROF_DRAW_CUE);
+                Vector2 cuePos = balls[0].pos;
+                Vector2 mousePos = mouse;
+                float angle = atan2f(mousePos.y - cuePos.y, mousePos.x - cuePos.x);
+
+                // draw cue: user's texture has tip on RIGHT
+                frameStats.use(cueTex.id != 0 ? cueTex.id : DrawStats::SHAPES);
+                if (cueTex.id != 0) {
+                    Texture2D &tx = cueTex;
+                    Rectangle src = { (float)tx.width, 0.0f, -(float)tx.width, (float)tx.height };
+                    float desiredLen = 180.0f * SCALE;
+                    float scaleX = desiredLen / (float)tx.width;
+                    float scaleY = (desiredLen / (float)tx.width);
+                    Rectangle dst = { cuePos.x - desiredLen*0.08f, cuePos.y - (float)tx.height*scaleY/2.0f, desiredLen, (float)tx.height*scaleY };
+                    Vector2 origin = { desiredLen*0.08f, (float)tx.height*scaleY/2.0f };
+                    DrawTexturePro(tx, src, dst, origin, angle*RAD2DEG, WHITE);
+                } else {
+                    // fallback simple line
+                    Vector2 butt = cuePos;
+                    Vector2 tip = { cuePos.x + cosf(angle)*(180.0f*SCALE), cuePos.y + sinf(angle)*(180.0f*SCALE) };
+                    DrawLineEx(butt, tip, 10.0f*SCALE, (Color){181,101,29,255});
+                }
 
-            // check balls
-            for (auto &b : balls) {
-                if (!b.active) continue;
-                if (b.id == 0) continue;
-                Vector2 p; float d;
-                if (RayBallHit(startTrace, dirBack, b.pos, MAX_TRACE, BALL_R, p, d)) {
-                    if (d < bestDist) { bestDist = d; bestHit = p; hitType = HIT_BALL; }
+                // TRAJECTORY: starts BEHIND cue ball
+                frameStats.use(DrawStats::SHAPES);
+                Vector2 dirBack = { -cosf(angle), -sinf(angle) };
+                Vector2 startTrace = { cuePos.x + dirBack.x * (BALL_R + 2.0f), cuePos.y + dirBack.y * (BALL_R + 2.0f) };
+                const float MAX_TRACE = 1200.0f;
+
+                // check pocket first
+                PROFILE_BEGIN(raycastStart);
+                float bestDist = 1e9f;
+                Vector2 bestHit = { startTrace.x + dirBack.x * MAX_TRACE, startTrace.y + dirBack.y * MAX_TRACE };
+                enum { NONE=0, HIT_BALL=1, HIT_CUSHION=2, HIT_POCKET=3 } hitType = NONE;
+                Vector2 hitNormal = { 0, 0 };
+
+                // check pockets
+                for (auto &h : holes) {
+                    // project the vector
+                    Vector2 toHole = { h.x - startTrace.x, h.y - startTrace.y };
+                    float proj = toHole.x*dirBack.x + toHole.y*dirBack.y;
+                    if (proj < 0 || proj > MAX_TRACE) continue;
+                    // perpendicular distance
+                    Vector2 closest = { startTrace.x + dirBack.x * proj, startTrace.y + dirBack.y * proj };
+                    float perp = Dist(closest, h);
+                    if (perp <= HOLE_R) {
+                        if (proj < bestDist) { bestDist = proj; bestHit = closest; hitType = HIT_POCKET; }
+                    }
                 }
-            }
 
-            // check cushions
-            for (auto &s : cushions) {
-                Vector2 p; float d;
-                if (RaySegmentHit(startTrace, dirBack, s, MAX_TRACE, BALL_R, p, d)) {
-                    if (d < bestDist) { bestDist = d; bestHit = p; hitType = HIT_CUSHION; hitSeg = s; }
+                // check balls (swept cue ball, line ends at the ghost-ball centre)
+                for (auto &b : balls) {
+                    if (!b.active) continue;
+                    if (b.id == 0) continue;
+                    SweepHit hit;
+                    if (SweepCircleVsCircle(startTrace, dirBack, MAX_TRACE, BALL_R, b.pos, BALL_R, hit)) {
+                        if (hit.dist < bestDist) { bestDist = hit.dist; bestHit = hit.center; hitType = HIT_BALL; }
+                    }
                 }
-            }
 
-            if (hitType == HIT_POCKET) {
-                // draw dashed line to pocket but do not display any cushion bounce leg
-                DrawDashedLine(startTrace, bestHit, 8.0f, 6.0f, WHITE);
-            } else if (hitType == HIT_BALL) {
-                DrawDashedLine(startTrace, bestHit, 8.0f, 6.0f, WHITE);
-            } else if (hitType == HIT_CUSHION) {
-                DrawDashedLine(startTrace, bestHit, 8.0f, 6.0f, WHITE);
-                // reflect once
-                Vector2 segDir = { hitSeg.b.x - hitSeg.a.x, hitSeg.b.y - hitSeg.a.y };
-                float segLen = sqrtf(segDir.x*segDir.x + segDir.y*segDir.y);
-                if (segLen > 1e-6f) {
-                    // normal pointing into play
-                    Vector2 segNorm = { -segDir.y/segLen, segDir.x/segLen };
-                    // ensure normal points against incoming direction
-                    if (segNorm.x * dirBack.x + segNorm.y * dirBack.y > 0) { segNorm.x *= -1.0f; segNorm.y *= -1.0f; }
-                    Vector2 refl = Reflect(dirBack, segNorm);
-                    Vector2 secondStart = { bestHit.x + refl.x * (BALL_R * 0.6f), bestHit.y + refl.y * (BALL_R * 0.6f) };
-                    // second leg stops on ball or pocket
-                    float bestDist2 = 1e9f; Vector2 bestHit2 = { secondStart.x + refl.x * 600.0f, secondStart.y + refl.y * 600.0f };
-                    int hitType2 = NONE;
-                    // pockets check
-                    for (auto &h : holes) {
-                        Vector2 toHole = { h.x - secondStart.x, h.y - secondStart.y };
-                        float proj = toHole.x*refl.x + toHole.y*refl.y;
-                        if (proj < 0 || proj > 600.0f) continue;
-                        Vector2 closest = { secondStart.x + refl.x * proj, secondStart.y + refl.y * proj };
-                        float perp = Dist(closest, h);
-                        if (perp <= HOLE_R) {
-                            if (proj < bestDist2) { bestDist2 = proj; bestHit2 = closest; hitType2 = HIT_POCKET; }
+                // check cushions
+                for (auto &s : cushions) {
+                    SweepHit hit;
+                    if (SweepCircleVsSegment(startTrace, dirBack, MAX_TRACE, BALL_R, s, hit)) {
+                        if (hit.dist < bestDist) { bestDist = hit.dist; bestHit = hit.center; hitType = HIT_CUSHION; hitNormal = hit.normal; }
+                    }
+                }
+                PROFILE_END(raycastStart, PROF_RAYCAST);
+
+                if (hitType == HIT_POCKET) {
+                    // draw dashed line to pocket but do not display any cushion bounce leg
+                    DrawDashedLine(startTrace, bestHit, 8.0f, 6.0f, WHITE);
+                } else if (hitType == HIT_BALL) {
+                    DrawDashedLine(startTrace, bestHit, 8.0f, 6.0f, WHITE);
+                } else if (hitType == HIT_CUSHION) {
+                    DrawDashedLine(startTrace, bestHit, 8.0f, 6.0f, WHITE);
+                    // reflect once about the contact normal (also right on the rounded cushion ends)
+                    {
+                        Vector2 refl = Reflect(dirBack, hitNormal);
+                        Vector2 secondStart = bestHit;
+                        PROFILE_BEGIN(raycast2Start);
+                        // second leg stops on ball or pocket
+                        float bestDist2 = 1e9f; Vector2 bestHit2 = { secondStart.x + refl.x * 600.0f, secondStart.y + refl.y * 600.0f };
+                        int hitType2 = NONE;
+                        // pockets check
+                        for (auto &h : holes) {
+                            Vector2 toHole = { h.x - secondStart.x, h.y - secondStart.y };
+                            float proj = toHole.x*refl.x + toHole.y*refl.y;
+                            if (proj < 0 || proj > 600.0f) continue;
+                            Vector2 closest = { secondStart.x + refl.x * proj, secondStart.y + refl.y * proj };
+                            float perp = Dist(closest, h);
+                            if (perp <= HOLE_R) {
+                                if (proj < bestDist2) { bestDist2 = proj; bestHit2 = closest; hitType2 = HIT_POCKET; }
+                            }
                         }
+                        // balls check
+                        for (auto &b : balls) {
+                            if (!b.active) continue;
+                            if (b.id == 0) continue;
+                            SweepHit hit;
+                            if (SweepCircleVsCircle(secondStart, refl, 600.0f, BALL_R, b.pos, BALL_R, hit)) {
+                                if (hit.dist < bestDist2) { bestDist2 = hit.dist; bestHit2 = hit.center; hitType2 = HIT_BALL; }
+                            }
+                        }
+                        PROFILE_END(raycast2Start, PROF_RAYCAST);
+                        // cushions for second leg NOT allowed to bounce again (max 1)
+                        DrawDashedLine(secondStart, bestHit2, 8.0f, 6.0f, WHITE);
                     }
-                    // balls check
+                } else {
+                    // nothing hit
+                    Vector2 full = { startTrace.x + dirBack.x * MAX_TRACE, startTrace.y + dirBack.y * MAX_TRACE };
+                    DrawDashedLine(startTrace, full, 8.0f, 6.0f, WHITE);
+                }
+
+                // Monte Carlo odds: chance over every ball that goes down in some sample
+                if (odds.samples > 0) {
+                    frameStats.use(fontTex);
                     for (auto &b : balls) {
-                        if (!b.active) continue;
-                        if (b.id == 0) continue;
-                        Vector2 p; float d;
-                        if (RayBallHit(secondStart, refl, b.pos, 600.0f, BALL_R, p, d)) {
-                            if (d < bestDist2) { bestDist2 = d; bestHit2 = p; hitType2 = HIT_BALL; }
-                        }
+                        if (!b.active || odds.pocketed[b.id] == 0) continue;
+                        int pct = (int)(odds.chance(b.id) * 100.0f + 0.5f);
+                        if (b.id == 0) DrawText(TextFormat("scratch %d%%", pct), (int)(b.pos.x - BALL_R*2.0f), (int)(b.pos.y + BALL_R*1.3f), 14, RED);
+                        else DrawText(TextFormat("%d%%", pct), (int)(b.pos.x - BALL_R*0.8f), (int)(b.pos.y - BALL_R*2.3f), 14, GOLD);
                     }
-                    // cushions for second leg NOT allowed to bounce again (max 1)
-                    DrawDashedLine(secondStart, bestHit2, 8.0f, 6.0f, WHITE);
+                    DrawText(TextFormat("%d sims%s", odds.samples, charging ? "" : " @ half power"), 420, 22, 14, LIGHTGRAY);
+                }
+            } // end draw cue+trajectory
+
+            // draw UI
+            PROFILE_BEGIN(hudStart);
+            // text and shapes alternate, so the HUD costs a bind per switch
+            const unsigned uiFont = customFont.texture.id != 0 ? customFont.texture.id : fontTex;
+            if (customFont.texture.id != 0) {
+                frameStats.use(uiFont);
+                DrawTextEx(customFont, "Power:", {20, 18}, uiSize, 0.0f, WHITE);
+                frameStats.use(DrawStats::SHAPES);
+                DrawRectangle(110, 20, 300, 18, LIGHTGRAY);
+                DrawRectangle(110, 20, (int)((power/MAX_POWER)*300.0f), 18, ORANGE);
+
+                frameStats.use(uiFont);
+                DrawTextEx(customFont, TextFormat("Turn: Player %d%s", currentPlayer, turnTag()), { SCREEN_W*0.5f - 70, 18 }, uiSize+2, 0.0f, YELLOW);
+                DrawTextEx(customFont, TextFormat("P1: %d", score[1]), {20, SCREEN_H - 88}, scoreSize, 0.0f, WHITE);
+                DrawTextEx(customFont, TextFormat("P2: %d", score[2]), {20, SCREEN_H - 52}, scoreSize, 0.0f, WHITE);
+                if (netMode) {
+                    // no Start/Stop online: the game begins when both sides are in
+                    if (state == MENU) DrawTextEx(customFont, "Waiting for the other player...", { SCREEN_W*0.5f - 190, SCREEN_H*0.5f - 14 }, uiSize+6, 0.0f, RAYWHITE);
+                } else if (state == MENU || state == STOPPED) {
+                    frameStats.use(DrawStats::SHAPES);
+                    DrawRectangleRec(btnStart, (Color){40,40,40,220});
+                    DrawRectangleLinesEx(btnStart, 2, Fade(RAYWHITE, 0.06f));
+                    frameStats.use(uiFont);
+                    DrawTextEx(customFont, "START", { btnStart.x + btnStart.width*0.14f, btnStart.y + (btnStart.height - titleSize)/2.0f }, titleSize, 0.0f, RAYWHITE);
+                } else {
+                    frameStats.use(DrawStats::SHAPES);
+                    DrawRectangleRec(btnStop, (Color){160,40,40,220});
+                    frameStats.use(uiFont);
+                    DrawTextEx(customFont, "STOP", { btnStop.x + 18, btnStop.y + 6 }, buttonSize, 0.0f, RAYWHITE);
+                }
+                if (state == STOPPED) {
+                    frameStats.use(uiFont);
+                    const char *res = (winner>0)?TextFormat("WINNER: Player %d", winner):"DRAW";
+                    DrawTextEx(customFont, res, { SCREEN_W*0.5f - 140, SCREEN_H*0.5f - 120 }, 34, 0.0f, GOLD);
                 }
             } else {
-                // nothing hit
-                Vector2 full = { startTrace.x + dirBack.x * MAX_TRACE, startTrace.y + dirBack.y * MAX_TRACE };
-                DrawDashedLine(startTrace, full, 8.0f, 6.0f, WHITE);
+                // fallback UI using default font
+                frameStats.use(uiFont);
+                DrawText("Power:", 20, 18, uiSize, WHITE);
+                frameStats.use(DrawStats::SHAPES);
+                DrawRectangle(110, 20, 300, 18, LIGHTGRAY);
+                DrawRectangle(110, 20, (int)((power/MAX_POWER)*300.0f), 18, ORANGE);
+                frameStats.use(uiFont);
+                DrawText(TextFormat("Turn: Player %d%s", currentPlayer, turnTag()), SCREEN_W/2 - 70, 18, uiSize+2, YELLOW);
+                DrawText(TextFormat("P1: %d", score[1]), 20, SCREEN_H - 88, scoreSize, WHITE);
+                DrawText(TextFormat("P2: %d", score[2]), 20, SCREEN_H - 52, scoreSize, WHITE);
+                if (netMode) {
+                    if (state == MENU) DrawText("Waiting for the other player...", SCREEN_W/2 - 190, SCREEN_H/2 - 14, uiSize+6, RAYWHITE);
+                } else if (state == MENU || state == STOPPED) {
+                    frameStats.use(DrawStats::SHAPES);
+                    DrawRectangleRec(btnStart, (Color){40,40,40,220});
+                    frameStats.use(uiFont);
+                    DrawText("START", (int)(btnStart.x + btnStart.width*0.28f), (int)(btnStart.y + btnStart.height*0.28f), titleSize, RAYWHITE);
+                } else {
+                    frameStats.use(DrawStats::SHAPES);
+                    DrawRectangleRec(btnStop, (Color){160,40,40,220});
+                    frameStats.use(uiFont);
+                    DrawText("STOP", (int)(btnStop.x + 18), (int)(btnStop.y + 6), buttonSize, RAYWHITE);
+                }
+                if (state == STOPPED) {
+                    frameStats.use(uiFont);
+                    if (winner>0) DrawText(TextFormat("WINNER: Player %d", winner), SCREEN_W/2 - 140, SCREEN_H/2 - 120, 34, GOLD);
+                    else DrawText("DRAW", SCREEN_W/2 - 40, SCREEN_H/2 - 120, 34, GOLD);
+                }
             }
-        } // end draw cue+trajectory
-
-        // draw UI
-        if (customFont.texture.id != 0) {
-            DrawTextEx(customFont, "Power:", {20, 18}, uiSize, 0.0f, WHITE);
-            DrawRectangle(110, 20, 300, 18, LIGHTGRAY);
-            DrawRectangle(110, 20, (int)((power/MAX_POWER)*300.0f), 18, ORANGE);
+            EndTextureMode();
+            PROFILE_END(hudStart, PROF_DRAW_HUD);
+            frameStats.flush();
+            memcpy(lastSceneKey, sceneKey, sizeof(sceneKey));
+            frameCached = true;
+            sceneStats = frameStats;
+        }
 
-            DrawTextEx(customFont, TextFormat("Turn: Player %d", currentPlayer), { SCREEN_W*0.5f - 70, 18 }, uiSize+2, 0.0f, YELLOW);
-            DrawTextEx(customFont, TextFormat("P1: %d", score[1]), {20, SCREEN_H - 88}, scoreSize, 0.0f, WHITE);
-            DrawTextEx(customFont, TextFormat("P2: %d", score[2]), {20, SCREEN_H - 52}, scoreSize, 0.0f, WHITE);
-            if (state == MENU || state == STOPPED) {
-                DrawRectangleRec(btnStart, (Color){40,40,40,220});
-                DrawRectangleLinesEx(btnStart, 2, Fade(RAYWHITE, 0.06f));
-                DrawTextEx(customFont, "START", { btnStart.x + btnStart.width*0.14f, btnStart.y + (btnStart.height - titleSize)/2.0f }, titleSize, 0.0f, RAYWHITE);
-            } else {
-                DrawRectangleRec(btnStop, (Color){160,40,40,220});
-                DrawTextEx(customFont, "STOP", { btnStop.x + 18, btnStop.y + 6 }, buttonSize, 0.0f, RAYWHITE);
-            }
-            if (state == STOPPED) {
-                const char *res = (winner>0)?TextFormat("WINNER: Player %d", winner):"DRAW";
-                DrawTextEx(customFont, res, { SCREEN_W*0.5f - 140, SCREEN_H*0.5f - 120 }, 34, 0.0f, GOLD);
-            }
-        } else {
-            // fallback UI using default font
-            DrawText("Power:", 20, 18, uiSize, WHITE);
-            DrawRectangle(110, 20, 300, 18, LIGHTGRAY);
-            DrawRectangle(110, 20, (int)((power/MAX_POWER)*300.0f), 18, ORANGE);
-            DrawText(TextFormat("Turn: Player %d", currentPlayer), SCREEN_W/2 - 70, 18, uiSize+2, YELLOW);
-            DrawText(TextFormat("P1: %d", score[1]), 20, SCREEN_H - 88, scoreSize, WHITE);
-            DrawText(TextFormat("P2: %d", score[2]), 20, SCREEN_H - 52, scoreSize, WHITE);
-            if (state == MENU || state == STOPPED) {
-                DrawRectangleRec(btnStart, (Color){40,40,40,220});
-                DrawText("START", (int)(btnStart.x + btnStart.width*0.28f), (int)(btnStart.y + btnStart.height*0.28f), titleSize, RAYWHITE);
-            } else {
-                DrawRectangleRec(btnStop, (Color){160,40,40,220});
-                DrawText("STOP", (int)(btnStop.x + 18), (int)(btnStop.y + 6), buttonSize, RAYWHITE);
+        PROFILE_BEGIN(presentStart);
+        BeginDrawing();
+        // Copy colour straight over (the cache's alpha channel is not 1 where
+        // translucent shapes were blended in); render textures are bottom-up.
+        ClearBackground(BLACK);
+        BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+        frameStats.use(frameCache.texture.id);
+        DrawTextureRec(frameCache.texture, { 0, 0, (float)SCREEN_W, -(float)SCREEN_H }, { 0, 0 }, WHITE);
+        EndBlendMode();
+        frameStats.flush();
+        // drawn straight to the screen so it never invalidates the cache
+        if (showDrawStats) {
+            frameStats.use(DrawStats::SHAPES);
+            DrawRectangle(SCREEN_W - 250, SCREEN_H - 130, 236, 62, Fade(BLACK, 0.6f));
+            frameStats.use(GetFontDefault().texture.id);
+            DrawText(TextFormat("frame: %d calls, %d binds", shownFrameStats.calls, shownFrameStats.binds), SCREEN_W - 242, SCREEN_H - 106, 14, LIGHTGRAY);
+            DrawText(TextFormat("scene: %d calls, %d binds", sceneStats.calls, sceneStats.binds), SCREEN_W - 242, SCREEN_H - 88, 14, LIGHTGRAY);
+            DrawText(TextFormat("startup: %.0f / %.0f ms (%s)", firstFrameMs, assetsReadyMs, decoded.fromBundle ? "bundle" : "sources"), SCREEN_W - 242, SCREEN_H - 124, 14, LIGHTGRAY);
+        }
+        if (showLatency) {
+            frameStats.use(DrawStats::SHAPES);
+            DrawRectangle(14, SCREEN_H - 100, 340, 80, Fade(BLACK, 0.6f));
+            frameStats.use(GetFontDefault().texture.id);
+            DrawText(TextFormat("input: %d polls this frame%s", input.polls(), fastInput ? "" : " (one per frame)"), 22, SCREEN_H - 94, 14, LIGHTGRAY);
+            DrawText(TextFormat("release -> shot    %5.1f avg %5.1f p99 ms", releaseToShot.average(), releaseToShot.p99()), 22, SCREEN_H - 76, 14, LIGHTGRAY);
+            DrawText(TextFormat("release -> screen  %5.1f avg %5.1f p99 ms", releaseToPhoton.average(), releaseToPhoton.p99()), 22, SCREEN_H - 58, 14, LIGHTGRAY);
+            DrawText(TextFormat("mouse -> screen    %5.1f avg %5.1f p99 ms", mouseToPhoton.average(), mouseToPhoton.p99()), 22, SCREEN_H - 40, 14, LIGHTGRAY);
+        }
+#ifdef BILLIARD_PROFILE
+        if (showProfile) {
+            // phase table (avg / p99 over the ring, "other" is the frame minus
+            // the top-level phases) and a frame-time graph, newest on the right
+            ProfileSummary prof = ProfileSummarize();
+            const int px = SCREEN_W - 262, py = 60, graphW = 240, graphH = 60;
+            int rows = PROF_PHASES + 2;
+            DrawRectangle(px - 8, py - 8, 256, rows*14 + graphH + 24, Fade(BLACK, 0.7f));
+            DrawText(TextFormat("frame      %6.2f  %6.2f ms", prof.frameAvgMs, prof.frameP99Ms), px, py, 12, WHITE);
+            float topLevel = 0.0f;
+            for (int p=0;p<PROF_PHASES;p++) {
+                if (ProfilePhaseDepth(p) == 0) topLevel += prof.avgMs[p];
+                DrawText(TextFormat("%s%-10s %6.2f  %6.2f", ProfilePhaseDepth(p) ? "  " : "", ProfilePhaseName(p), prof.avgMs[p], prof.p99Ms[p]),
+                         px, py + 14*(p+1), 12, ProfilePhaseDepth(p) ? GRAY : LIGHTGRAY);
             }
-            if (state == STOPPED) {
-                if (winner>0) DrawText(TextFormat("WINNER: Player %d", winner), SCREEN_W/2 - 140, SCREEN_H/2 - 120, 34, GOLD);
-                else DrawText("DRAW", SCREEN_W/2 - 40, SCREEN_H/2 - 120, 34, GOLD);
+            DrawText(TextFormat("other      %6.2f", fmaxf(0.0f, prof.frameAvgMs - topLevel)), px, py + 14*(PROF_PHASES+1), 12, GRAY);
+            int gy = py + rows*14 + graphH;
+            const float MS_FULL = 1000.0f / 30.0f;   // graph top = 30 FPS
+            for (int i=0;i<std::min(graphW, ProfileFrameCount());i++) {
+                const ProfileFrame &f = ProfileFrameAt(i);
+                int x = px + graphW - 1 - i;
+                int h = (int)(fminf(f.frameMs / MS_FULL, 1.0f) * graphH);
+                int hp = (int)(fminf(f.phaseMs[PROF_PHYSICS] / MS_FULL, 1.0f) * graphH);
+                DrawLine(x, gy, x, gy - h, f.frameMs > MS_FULL*0.5f ? RED : LIGHTGRAY);
+                if (hp > 0) DrawLine(x, gy, x, gy - hp, ORANGE);
             }
+            DrawLine(px, gy - graphH/2, px + graphW, gy - graphH/2, Fade(GREEN, 0.6f));   // 60 FPS budget
         }
-
+#endif
         EndDrawing();
+        PROFILE_END(presentStart, PROF_PRESENT);
+        shownFrameStats = frameStats;
+        const double presentMs = msSinceStart();
+        pollInput();
+        if (aimVisible) mouseToPhoton.add((float)(presentMs - mouseMs));
+        if (photonFromMs >= 0.0 && physTick != photonTick) {
+            releaseToPhoton.add((float)(presentMs - photonFromMs));
+            if (showLatency) TraceLog(LOG_INFO, "LATENCY: shot applied %.1f ms, on screen %.1f ms after the release", releaseToShot.last(), releaseToPhoton.last());
+            photonFromMs = -1.0;
+        }
 
-        // restart quick R
-        if (IsKeyPressed(KEY_R)) {
-            state = PLAY;
-            balls = initBalls();
-            score[1]=score[2]=0;
-            currentPlayer = 1;
-            waitingPlacement = false;
-            shotInProgress = false;
-            charging = false;
-            power = 0.0f;
-            gameOver = false;
-            winner = -1;
-            slowTimer = 0.0f;
+        // Nothing moving, no charge, no computer turn and no odds still coming
+        // in: block in EndDrawing until the next input event instead of
+        // spinning at 60 FPS.
+        bool idle = tableStill && !shotInProgress && !charging && ignoreInputFramesAfterStart == 0
+                    && !(state == PLAY && !gameOver && aiTurn()) && !aimOdds.busy() && !netMode;   // packets are not input events
+        if (idle != waitingEvents) {
+            if (idle) EnableEventWaiting(); else DisableEventWaiting();
+            waitingEvents = idle;
+        }
+        bool fast = aimVisible && !idle;
+        if (fast != fastInput) {
+            SetTargetFPS(fast ? 0 : 60);
+            fastInput = fast;
+        }
+        if (fast) {
+            for (double left; (left = frameStartMs + FRAME_MS - msSinceStart()) > 0.0; ) {
+                WaitTime(fmin(left, INPUT_SAMPLE_MS) / 1000.0);
+                PollInputEvents();
+                pollInput();
+            }
         }
 
+
+#ifdef BILLIARD_ALLOC_CHECK
+        // steady state: a PLAY frame that neither started, restarted nor ended a game
+        if (stateAtFrameStart == PLAY && state == PLAY && physTick >= tickAtFrameStart) {
+            long n = AllocCount() - allocsAtFrameStart;
+            if (n > 0) TraceLog(LOG_WARNING, "ALLOC: %ld heap allocation(s) in steady-state frame at tick %u", n, physTick);
+            steadyAllocs += n;
+        }
+#endif
+        PROFILE_FRAME_END();
     } // main loop
 
     // cleanup
-    for (int i=0;i<16;i++) if (ballTex[i].id != 0) UnloadTexture(ballTex[i]);
-    if (cueTex.id != 0) UnloadTexture(cueTex);
-    if (customFont.texture.id != 0) UnloadFont(customFont);
+    saveReplay();
+#ifdef BILLIARD_PROFILE
+    if (ProfileWriteCsv("profile.csv") && ProfileWriteJson("profile.json"))
+        TraceLog(LOG_INFO, "PROFILE: %d frames written to profile.csv / profile.json", ProfileFrameCount());
+#endif
+    UnloadRenderTexture(frameCache);
+    UnloadRenderTexture(tableLayer);
+    UnloadAssets(assets);
 
     CloseWindow();
+#ifdef BILLIARD_ALLOC_CHECK
+    TraceLog(LOG_INFO, "ALLOC: %ld heap allocation(s) in steady-state frames", steadyAllocs);
+    if (steadyAllocs > 0) return 3;
+#endif
     return 0;
 }
@@ -0,0 +1,643 @@
+// Headless micro-benchmarks - no window, no raylib needed.
+// g++ -O2 billiard_bench.cpp table_sim.cpp contact_solver.cpp table_events.cpp table_query.cpp ball_soa.cpp thread_pool.cpp game_rules.cpp shot_ai.cpp table_hash.cpp table_env.cpp game_snapshot.cpp profiler.cpp -o billiard_bench -lpthread
+// ./billiard_bench [--rays N] [--balls N] [--threads N] [--tables N]
+// ./billiard_bench --suite [--json FILE] [--baseline FILE] [--tolerance PCT] [--accept-changed] [--reps N] [--warmup N]
+
+#include "table_sim.h"
+#include "table_query.h"
+#include "ball_soa.h"
+#include "shot_ai.h"
+#include "table_env.h"
+#include "game_snapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+// ---------------- Reference samplers (the old aim preview) ----------------
+
+// Ray-ball sampling - returns first hit along ray (step sampling)
+static bool RayBallHit(const Vector2 &rayStart, const Vector2 &dirNorm, const Vector2 &ballPos, float maxDist, float ballRadius, Vector2 &outPoint, float &outDist) {
+    const float step = fmaxf(3.0f, ballRadius * 0.5f);
+    float traveled = 0.0f;
+    while (traveled <= maxDist) {
+        Vector2 p = { rayStart.x + dirNorm.x * traveled, rayStart.y + dirNorm.y * traveled };
+        float d = Dist(p, ballPos);
+        if (d <= ballRadius) { outPoint = p; outDist = traveled; return true; }
+        traveled += step;
+    }
+    return false;
+}
+
+// Ray-segment sampling - detect near-cushion
+static bool RaySegmentHit(const Vector2 &rayStart, const Vector2 &dirNorm, const Segment &seg, float maxDist, float radius, Vector2 &outPoint, float &outDist) {
+    const float step = fmaxf(4.0f, radius * 0.6f);
+    float traveled = 0.0f;
+    while (traveled <= maxDist) {
+        Vector2 p = { rayStart.x + dirNorm.x * traveled, rayStart.y + dirNorm.y * traveled };
+        float t; Vector2 cp = ClosestPointOnSegment(seg.a, seg.b, p, t);
+        float d = Dist(p, cp);
+        if (d <= radius) { outPoint = cp; outDist = traveled; return true; }
+        traveled += step;
+    }
+    return false;
+}
+
+// ---------------- Aim preview raycast ----------------
+
+struct Ray { Vector2 start, dir; };
+
+static double NowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// First leg of the preview: every object ball and every cushion, as the game does per frame.
+static float SampledPreview(const TableSim &sim, const Ray &r, float maxTrace, float radius) {
+    float best = 1e9f;
+    for (auto &b : sim.balls) {
+        if (!b.active || b.id == 0) continue;
+        Vector2 p; float d;
+        if (RayBallHit(r.start, r.dir, b.pos, maxTrace, radius, p, d) && d < best) best = d;
+    }
+    for (auto &s : sim.layout.cushions) {
+        Vector2 p; float d;
+        if (RaySegmentHit(r.start, r.dir, s, maxTrace, sim.layout.ballR, p, d) && d < best) best = d;
+    }
+    return best;
+}
+
+static float SweptPreview(const TableSim &sim, const Ray &r, float maxTrace, float radius) {
+    float best = 1e9f;
+    SweepHit hit;
+    for (auto &b : sim.balls) {
+        if (!b.active || b.id == 0) continue;
+        // zero-radius sweep against a BALL_R circle is the sampler's test, done exactly
+        if (SweepCircleVsCircle(r.start, r.dir, maxTrace, 0.0f, b.pos, radius, hit) && hit.dist < best) best = hit.dist;
+    }
+    for (auto &s : sim.layout.cushions)
+        if (SweepCircleVsSegment(r.start, r.dir, maxTrace, sim.layout.ballR, s, hit) && hit.dist < best) best = hit.dist;
+    return best;
+}
+
+static void BenchRaycast(long rays) {
+    TableSim sim(MakeTableLayout(1000, 650));
+    const float MAX_TRACE = 1200.0f;
+    const float R = sim.layout.ballR;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+
+    std::vector<Ray> batch(4096);
+    for (auto &r : batch) {
+        float a = angleDist(rng);
+        Vector2 cue = sim.balls[0].pos;
+        r.dir = { cosf(a), sinf(a) };
+        r.start = { cue.x + r.dir.x*(R + 2.0f), cue.y + r.dir.y*(R + 2.0f) };
+    }
+
+    volatile float sink = 0.0f;
+    double t0 = NowNs();
+    for (long i = 0; i < rays; i++) sink = sink + SampledPreview(sim, batch[i % batch.size()], MAX_TRACE, R);
+    double sampledNs = (NowNs() - t0) / rays;
+
+    t0 = NowNs();
+    for (long i = 0; i < rays; i++) sink = sink + SweptPreview(sim, batch[i % batch.size()], MAX_TRACE, R);
+    double sweptNs = (NowNs() - t0) / rays;
+
+    // a sampler "miss" is a hit the exact query finds that stepping skipped over
+    int missed = 0;
+    for (auto &r : batch) {
+        float a = SampledPreview(sim, r, MAX_TRACE, R);
+        float b = SweptPreview(sim, r, MAX_TRACE, R);
+        if (b < 1e8f && (a >= 1e8f || a - b > 8.0f)) missed++;
+    }
+
+    printf("raycast  rays=%ld  sampled=%.0f ns/preview  swept=%.0f ns/preview  speedup=%.1fx  sampler misses=%d/%zu\n",
+           rays, sampledNs, sweptNs, sampledNs / sweptNs, missed, batch.size());
+}
+
+// ---------------- SoA step kernels ----------------
+
+static void BenchKernels(int nBalls) {
+    // nBalls spread over a table scaled up to keep the 8-ball density
+    float side = sqrtf((float)nBalls / 16.0f);
+    TableSim sim(MakeTableLayout((int)(1000 * side), (int)(650 * side)));
+    const TableLayout &L = sim.layout;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> px(L.play.x, L.play.x + L.play.width), py(L.play.y, L.play.y + L.play.height), pv(-8.0f, 8.0f);
+    std::vector<Ball> balls(nBalls);
+    for (int i=0;i<nBalls;i++) balls[i] = { { px(rng), py(rng) }, { pv(rng), pv(rng) }, true, i % 16, 0 };
+
+    const int reps = std::max(20, 2000000 / (nBalls * 16));
+    for (int path = KERNEL_SCALAR; path <= KERNEL_AVX2; path++) {
+        if (!KernelSupported((KernelPath)path)) continue;
+        const SoaKernels &k = GetSoaKernels((KernelPath)path);
+        BallSoA soa;
+        std::vector<uint64_t> mask((nBalls + 63) / 64 + 1);
+        std::vector<int> pairs;
+        double integrateNs = 0, pocketNs = 0, cushionNs = 0, pairNs = 0;
+        for (int r=0;r<reps;r++) {
+            soa.load(balls);
+            double t0 = NowNs();
+            k.integrate(soa, FRICTION, MIN_VEL);
+            double t1 = NowNs();
+            k.withinAny(soa, L.holes, L.config.pockets, L.holeR - 4.0f, mask.data());
+            double t2 = NowNs();
+            // boundary: one field gather per ball, the same on every path
+            for (int i=0;i<soa.count;i++) {
+                float depth; Vector2 n;
+                if (L.field->contact({ soa.x[i], soa.y[i] }, depth, n)) soa.x[i] += n.x*depth;
+            }
+            double t3 = NowNs();
+            pairs.clear();
+            k.overlapPairs(soa, 2.0f*L.ballR, pairs);
+            double t4 = NowNs();
+            integrateNs += t1 - t0; pocketNs += t2 - t1; cushionNs += t3 - t2; pairNs += t4 - t3;
+        }
+        double per = (double)reps * nBalls;
+        printf("kernels  %-6s balls=%d  integrate=%.2f  pockets=%.2f  cushions=%.2f  pairs=%.2f ns/ball\n",
+               k.name, nBalls, integrateNs / per, pocketNs / per, cushionNs / per, pairNs / per);
+    }
+}
+
+// ---------------- Parallel shot search ----------------
+
+static void BenchShotSearch(int maxThreads) {
+    // a scattered mid-game table: the break, then whatever is left
+    TableSim table(MakeTableLayout(1000, 650));
+    table.shoot(0.02f, MAX_POWER);
+    table.advanceUntilRest();
+    AiConfig cfg;
+    cfg.budgetMs = 0.0;   // full grid, so every thread count does the same work
+
+    double baseRate = 0.0;
+    AiShot first;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        ThreadPool pool(threads);
+        double t0 = NowNs();
+        AiShot best = FindBestShot(table, pool, cfg);
+        double sec = (NowNs() - t0) * 1e-9;
+        double rate = best.evaluated / sec;
+        if (threads == 1) { baseRate = rate; first = best; }
+        bool same = best.angle == first.angle && best.power == first.power;
+        printf("search   threads=%-2d candidates=%ld  %.0f candidates/s  speedup=%.2fx  best=%.3f rad @ %.1f (score %.1f)%s\n",
+               threads, best.evaluated, rate, rate / baseRate, best.angle, best.power, best.score, same ? "" : "  MISMATCH");
+        if (threads >= maxThreads) break;
+    }
+
+    // the same table twice through a shot cache: the first search fills it,
+    // the second is all lookups and must still pick the same shot
+    ShotCache cache;
+    cfg.cache = &cache;
+    ThreadPool pool(maxThreads);
+    for (const char *pass : { "cold", "warm" }) {
+        double t0 = NowNs();
+        AiShot best = FindBestShot(table, pool, cfg);
+        double sec = (NowNs() - t0) * 1e-9;
+        double rate = best.evaluated / sec;
+        bool same = best.angle == first.angle && best.power == first.power;
+        printf("search   cache=%s threads=%-2d candidates=%ld cached=%ld  %.0f candidates/s  speedup=%.2fx%s\n",
+               pass, maxThreads, best.evaluated, best.cached, rate, rate / baseRate, same ? "" : "  MISMATCH");
+    }
+}
+
+// ---------------- Batch environment ----------------
+
+static void BenchEnv(int tables, int maxThreads) {
+    const int STEPS = 8;
+    std::vector<EnvAction> actions((size_t)tables * STEPS);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f), power(2.0f, MAX_POWER), place(0.0f, 1.0f);
+    for (auto &a : actions) a = { angle(rng), power(rng), place(rng), place(rng) };
+    std::vector<float> obs((size_t)tables * ENV_OBS_FLOATS), rewards(tables);
+    std::vector<unsigned char> dones(tables);
+
+    double baseRate = 0.0;
+    double firstSum = 0.0;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        EnvBatch *env = EnvBatchCreate(tables, threads);
+        EnvBatchReset(env, obs.data());
+        double sum = 0.0;
+        long games = 0;
+        double t0 = NowNs();
+        for (int s=0;s<STEPS;s++) {
+            EnvBatchStep(env, actions.data() + (size_t)s*tables, obs.data(), rewards.data(), dones.data());
+            for (int i=0;i<tables;i++) { sum += rewards[i]; games += dones[i]; }
+        }
+        double sec = (NowNs() - t0) * 1e-9;
+        EnvBatchDestroy(env);
+        for (float o : obs) sum += o;
+        double rate = (double)tables * STEPS / sec;
+        if (threads == 1) { baseRate = rate; firstSum = sum; }
+        printf("env      threads=%-2d tables=%d  %.0f table-shots/s  speedup=%.2fx  games ended=%ld%s\n",
+               threads, tables, rate, rate / baseRate, games, sum == firstSum ? "" : "  MISMATCH");
+        if (threads >= maxThreads) break;
+    }
+}
+
+// ---------------- Snapshots ----------------
+
+static void BenchSnapshot() {
+    const int N = 1000000;
+    TableSim table(MakeTableLayout(1000, 650));
+    TurnState turn;
+    table.shoot(0.02f, MAX_POWER);
+    table.advance(30.0f);   // mid-break, balls moving
+    GameSnapshot snap;
+    double t0 = NowNs();
+    for (int i=0;i<N;i++) SaveSnapshot(table, turn, (uint32_t)i, snap);
+    double saveNs = (NowNs() - t0) / N;
+    float sum = 0.0f;
+    t0 = NowNs();
+    for (int i=0;i<N;i++) { RestoreSnapshot(snap, table, turn); sum += table.balls[i & 15].pos.x; }
+    double restoreNs = (NowNs() - t0) / N;
+    printf("snapshot bytes=%zu  save=%.1f ns  restore=%.1f ns  (checksum %.0f)\n", sizeof(GameSnapshot), saveNs, restoreNs, sum);
+}
+
+// ---------------- Physics suite ----------------
+// Canonical scenes run on the game's own physics with warm-up, fixed
+// repetitions and a median, so numbers are comparable run to run and against
+// a stored baseline. Every shot is deterministic: steps per shot only changes
+// when the physics does.
+
+struct SuiteOptions {
+    int reps = 11;
+    int warmup = 3;
+    double minPassMs = 20.0;   // each repetition repeats its shots to at least this long
+};
+
+struct SuiteResult {
+    std::string name, engine;
+    int shots;
+    double stepsPerShot, nsPerStep, nsPerStepMin, shotsPerSec;
+};
+
+struct SuiteShot { TableSim start; float angle, power; };
+
+// A pass runs every shot of a scenario once and adds the steps taken and the
+// nanoseconds spent on them (setup excluded).
+template <class Pass>
+static SuiteResult Measure(const char *name, const char *engine, int shots, const SuiteOptions &opt, Pass pass) {
+    long steps = 0; double ns = 0.0;
+    for (int w=0;w<opt.warmup;w++) pass(steps, ns);
+    int inner = 1;
+    if (opt.warmup > 0 && ns > 0.0) inner = std::max(1, (int)ceil(opt.minPassMs * 1e6 / (ns / opt.warmup)));
+
+    std::vector<double> perStep;
+    long repSteps = 0;
+    for (int r=0;r<opt.reps;r++) {
+        steps = 0; ns = 0.0;
+        for (int i=0;i<inner;i++) pass(steps, ns);
+        perStep.push_back(ns / std::max(1L, steps));
+        repSteps = steps;
+    }
+    std::sort(perStep.begin(), perStep.end());
+    SuiteResult res;
+    res.name = name;
+    res.engine = engine;
+    res.shots = shots;
+    res.stepsPerShot = (double)repSteps / ((double)inner * shots);
+    res.nsPerStep = perStep[perStep.size() / 2];
+    res.nsPerStepMin = perStep[0];
+    res.shotsPerSec = 1e9 / (res.nsPerStep * res.stepsPerShot);
+    return res;
+}
+
+// one 60 Hz frame per step: advance(1) for the event engine, step() for the frame stepper
+static int RunToRest(TableSim &sim, bool event) {
+    if (!event) return sim.stepUntilRest();
+    int steps = 0;
+    while (!sim.atRest() && steps < 20000) { sim.advance(1.0f); steps++; }
+    return steps;
+}
+
+static SuiteResult MeasureShots(const char *name, bool event, const std::vector<SuiteShot> &shots, const SuiteOptions &opt) {
+    return Measure(name, event ? "event" : "step", (int)shots.size(), opt, [&](long &steps, double &ns) {
+        for (auto &s : shots) {
+            TableSim sim = s.start;
+            sim.shoot(s.angle, s.power);
+            double t0 = NowNs();
+            steps += RunToRest(sim, event);
+            ns += NowNs() - t0;
+        }
+    });
+}
+
+static std::vector<SuiteResult> RunSuite(const SuiteOptions &opt) {
+    const TableLayout L = MakeTableLayout(1000, 650);
+    const float BREAK = 3.14159265f;   // cue ball straight at the rack
+    TableSim rack(L);
+
+    // 15 balls hex-packed (4,4,4,3) in the middle of the table, just apart
+    TableSim cluster(L);
+    {
+        Vector2 c = { L.play.x + L.play.width*0.5f, L.play.y + L.play.height*0.5f };
+        float sep = 2.0f*L.ballR + 0.01f;
+        int k = 1;
+        for (int r=0;r<4;r++) {
+            int n = r < 3 ? 4 : 3;
+            for (int i=0;i<n;i++, k++) {
+                cluster.balls[k].pos = { c.x + (i - (n-1)*0.5f + (r%2)*0.5f)*sep, c.y + (r - 1.5f)*sep*0.866f };
+            }
+        }
+    }
+    // the cue ball alone: banks and slow rolls only ever meet cushions
+    TableSim cueOnly(L);
+    for (size_t i=1;i<cueOnly.balls.size();i++) cueOnly.balls[i].active = false;
+
+    struct Scene { const char *name; std::vector<SuiteShot> shots; };
+    std::vector<Scene> scenes = {
+        { "break_33",   { { rack, BREAK, MAX_POWER*0.33f } } },
+        { "break_66",   { { rack, BREAK, MAX_POWER*0.66f } } },
+        { "break_100",  { { rack, BREAK, MAX_POWER } } },
+        { "cluster",    { { cluster, BREAK, MAX_POWER }, { cluster, BREAK + 0.12f, MAX_POWER*0.6f } } },
+        { "banks",      { { cueOnly, 0.35f, MAX_POWER }, { cueOnly, 1.2f, MAX_POWER }, { cueOnly, 2.6f, MAX_POWER*0.8f }, { cueOnly, 4.0f, MAX_POWER } } },
+        // starting speeds a few times MIN_VEL: hundreds of frames of crawling
+        { "slow_roll",  { { cueOnly, BREAK, 0.5f }, { cueOnly, 1.9f, 1.0f }, { cueOnly, 0.4f, 1.5f } } },
+    };
+
+    std::vector<SuiteResult> results;
+    for (auto &sc : scenes)
+        for (bool event : { true, false }) results.push_back(MeasureShots(sc.name, event, sc.shots, opt));
+
+    // the aim preview's swept first leg, fanned round the cue ball on the
+    // rack and on the table the full break leaves
+    TableSim broken = rack;
+    broken.shoot(BREAK, MAX_POWER);
+    broken.advanceUntilRest();
+    std::vector<std::pair<const TableSim *, Ray>> rays;
+    for (const TableSim *t : { &rack, &broken }) {
+        Vector2 cue = t->balls[0].pos;
+        for (int i=0;i<256;i++) {
+            float a = i * (2.0f * 3.14159265f / 256);
+            Ray r;
+            r.dir = { cosf(a), sinf(a) };
+            r.start = { cue.x + r.dir.x*(L.ballR + 2.0f), cue.y + r.dir.y*(L.ballR + 2.0f) };
+            rays.push_back({ t, r });
+        }
+    }
+    volatile float sink = 0.0f;
+    results.push_back(Measure("aim_preview", "swept", (int)rays.size(), opt, [&](long &steps, double &ns) {
+        double t0 = NowNs();
+        for (auto &r : rays) sink = sink + SweptPreview(*r.first, r.second, 1200.0f, L.ballR);
+        ns += NowNs() - t0;
+        steps += (long)rays.size();
+    }));
+    return results;
+}
+
+static void PrintSuite(const std::vector<SuiteResult> &results) {
+    printf("%-12s %-6s %10s %12s %12s %12s\n", "scenario", "engine", "steps/shot", "ns/step", "ns/step min", "shots/s");
+    for (auto &r : results)
+        printf("%-12s %-6s %10.1f %12.1f %12.1f %12.0f\n", r.name.c_str(), r.engine.c_str(), r.stepsPerShot, r.nsPerStep, r.nsPerStepMin, r.shotsPerSec);
+}
+
+// one result per line, so a baseline reads back with sscanf
+static bool WriteSuiteJson(const char *path, const std::vector<SuiteResult> &results, const SuiteOptions &opt) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"suite\": 1,\n  \"compiler\": \"%s\",\n  \"reps\": %d,\n  \"warmup\": %d,\n  \"results\": [\n", __VERSION__, opt.reps, opt.warmup);
+    for (size_t i=0;i<results.size();i++) {
+        const SuiteResult &r = results[i];
+        fprintf(f, "    { \"name\": \"%s\", \"engine\": \"%s\", \"shots\": %d, \"steps_per_shot\": %.3f, \"ns_per_step\": %.2f, \"ns_per_step_min\": %.2f, \"shots_per_sec\": %.1f }%s\n",
+                r.name.c_str(), r.engine.c_str(), r.shots, r.stepsPerShot, r.nsPerStep, r.nsPerStepMin, r.shotsPerSec, i+1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+static bool ReadSuiteJson(const char *path, std::vector<SuiteResult> &results) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char name[64], engine[16];
+        SuiteResult r;
+        if (sscanf(line, " { \"name\": \"%63[^\"]\", \"engine\": \"%15[^\"]\", \"shots\": %d, \"steps_per_shot\": %lf, \"ns_per_step\": %lf, \"ns_per_step_min\": %lf, \"shots_per_sec\": %lf",
+                   name, engine, &r.shots, &r.stepsPerShot, &r.nsPerStep, &r.nsPerStepMin, &r.shotsPerSec) != 7) continue;
+        r.name = name;
+        r.engine = engine;
+        results.push_back(r);
+    }
+    fclose(f);
+    return !results.empty();
+}
+
+// Returns the number of failures: best-repetition ns/step more than
+// tolerance percent above the baseline (interference only ever adds time,
+// so the minimum is the steadier number), a different steps/shot (the
+// physics changed, so the times are not comparable; acceptChanged only
+// reports it), and baseline scenarios the run no longer has.
+static int CompareSuite(const std::vector<SuiteResult> &now, const std::vector<SuiteResult> &base, double tolerancePct, bool acceptChanged) {
+    int failures = 0;
+    printf("\n%-12s %-6s %12s %12s %8s\n", "scenario", "engine", "base min", "now min", "delta");
+    for (auto &r : now) {
+        auto b = std::find_if(base.begin(), base.end(), [&](const SuiteResult &x) { return x.name == r.name && x.engine == r.engine; });
+        if (b == base.end()) { printf("%-12s %-6s %12s %12.1f %8s  new\n", r.name.c_str(), r.engine.c_str(), "-", r.nsPerStepMin, "-"); continue; }
+        double delta = (r.nsPerStepMin / b->nsPerStepMin - 1.0) * 100.0;
+        const char *status = "";
+        if (fabs(r.stepsPerShot - b->stepsPerShot) > 1e-3) {
+            status = "  CHANGED (steps/shot differs, physics changed)";
+            if (!acceptChanged) failures++;
+        }
+        else if (delta > tolerancePct) { status = "  REGRESSION"; failures++; }
+        else if (delta < -tolerancePct) status = "  faster";
+        printf("%-12s %-6s %12.1f %12.1f %+7.1f%%%s\n", r.name.c_str(), r.engine.c_str(), b->nsPerStepMin, r.nsPerStepMin, delta, status);
+    }
+    for (auto &b : base) {
+        bool ran = std::any_of(now.begin(), now.end(), [&](const SuiteResult &x) { return x.name == b.name && x.engine == b.engine; });
+        if (ran) continue;
+        printf("%-12s %-6s %12.1f %12s %8s  MISSING\n", b.name.c_str(), b.engine.c_str(), b.nsPerStepMin, "-", "-");
+        failures++;
+    }
+    return failures;
+}
+
+// ---------------- Break ----------------
+// The straight break is mirror-symmetric about the long axis, so any
+// asymmetry in the result is the contact resolution's doing.
+
+// how far the table is from its own mirror image: for each ball, the distance
+// from its reflection to the nearest ball
+static float MirrorError(const TableSim &sim) {
+    const float axis = sim.layout.play.y + sim.layout.play.height*0.5f;
+    float worst = 0.0f;
+    for (auto &b : sim.balls) {
+        if (!b.active) continue;
+        Vector2 m = { b.pos.x, 2.0f*axis - b.pos.y };
+        float nearest = 1e30f;
+        for (auto &o : sim.balls) if (o.active) nearest = fminf(nearest, Dist(m, o.pos));
+        worst = fmaxf(worst, nearest);
+    }
+    return worst;
+}
+
+static float WorstOverlap(const TableSim &sim) {
+    float worst = 0.0f;
+    for (size_t i=0;i<sim.balls.size();i++)
+        for (size_t j=i+1;j<sim.balls.size();j++)
+            if (sim.balls[i].active && sim.balls[j].active)
+                worst = fmaxf(worst, 2.0f*sim.layout.ballR - Dist(sim.balls[i].pos, sim.balls[j].pos));
+    return worst;
+}
+
+static void BenchBreak() {
+    const int N = 200;
+    const TableLayout L = MakeTableLayout(1000, 650);
+    const float BREAK = 3.14159265f;
+    const struct { const char *name; bool sequential, event; } modes[] = {
+        { "sequential", true, false }, { "solver", false, false }, { "event", false, true },
+    };
+    for (auto &m : modes) {
+        // one instrumented run for the table's shape
+        TableSim sim(L);
+        sim.sequentialContacts = m.sequential;
+        sim.shoot(BREAK, MAX_POWER);
+        int frames = 0;
+        float at30 = 0.0f, overlap = 0.0f;
+        while (!sim.atRest() && frames < 20000) {
+            if (m.event) sim.advance(1.0f); else sim.step();
+            frames++;
+            if (frames == 30) at30 = MirrorError(sim);
+            overlap = fmaxf(overlap, WorstOverlap(sim));
+        }
+        int potted = (int)sim.shotPocketed.size();
+        float atRest = MirrorError(sim);
+        // then timed runs
+        long steps = 0;
+        double t0 = NowNs();
+        for (int i=0;i<N;i++) {
+            TableSim t(L);
+            t.sequentialContacts = m.sequential;
+            t.shoot(BREAK, MAX_POWER);
+            steps += RunToRest(t, m.event);
+        }
+        double ns = NowNs() - t0;
+        printf("break %-10s frames=%5d  %6.0f ns/frame  %7.1f us/break  mirror error %.3f px at 30 frames, %.3f px at rest  overlap carried %.3f px  potted %d\n",
+               m.name, frames, ns / std::max(1L, steps), ns / N / 1e3, at30, atRest, overlap, potted);
+    }
+}
+
+// ---------------- Cut angle ----------------
+// A lone cue ball driven into a lone object ball whose centre is `offset`
+// off the line of aim: the object ball must leave at asin(offset / 2R) off
+// that line, however fast the cue ball closes.
+
+// the object ball's departure angle in degrees, or -1 if it was never hit
+static float CutAngle(const TableLayout &L, bool sequential, bool event, float offset, float power) {
+    TableSim sim(L);
+    sim.sequentialContacts = sequential;
+    for (size_t i=2;i<sim.balls.size();i++) sim.balls[i].active = false;
+    const float y = L.play.y + L.play.height*0.5f;
+    sim.balls[0].pos = { L.play.x + L.play.width*0.25f, y };
+    sim.balls[1].pos = { L.play.x + L.play.width*0.5f, y + offset };
+    sim.shoot(3.14159265f, power);
+    for (int frames=0; frames<2000 && !sim.atRest(); frames++) {
+        if (event) sim.advance(1.0f); else sim.step();
+        const Vector2 v = sim.balls[1].vel;
+        if (v.x != 0.0f || v.y != 0.0f) return atan2f(fabsf(v.y), v.x) * 57.29578f;
+    }
+    return -1.0f;
+}
+
+static void BenchCutAngle() {
+    const TableLayout L = MakeTableLayout(1000, 650);
+    const float R = L.ballR;
+    const struct { const char *name; bool sequential, event; } modes[] = {
+        { "sequential", true, false }, { "solver", false, false }, { "event", false, true },
+    };
+    for (float offset : { 0.5f, 1.0f, 1.5f })
+        for (float power : { 5.0f, MAX_POWER }) {
+            const float exact = asinf(offset*0.5f) * 57.29578f;
+            printf("cut %.1fR power %4.1f  exact %5.1f deg", offset, power, exact);
+            for (auto &m : modes) printf("  %s %5.1f", m.name, CutAngle(L, m.sequential, m.event, offset*R, power));
+            printf("\n");
+        }
+}
+
+// ---------------- table variants ----------------
+
+// Every TableConfig, random shots with step() (best of a few runs).
+static void BenchTables() {
+    const int SHOTS = 300, REPS = 5;
+    const char *names[] = { "8ball", "9ball", "4pocket", "snooker" };
+    for (const char *name : names) {
+        const TableLayout L = MakeTableLayout(*FindTableConfig(name), 1000, 650);
+        double ns = 1e30;
+        long frames = 0;
+        int potted = 0;
+        for (int rep=0; rep<REPS; rep++) {
+            TableSim sim(L);
+            std::mt19937 rng(11);
+            std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f), powerDist(2.0f, MAX_POWER);
+            frames = 0;
+            potted = 0;
+            double t0 = NowNs();
+            for (int s=0;s<SHOTS;s++) {
+                sim.shoot(angleDist(rng), powerDist(rng));
+                frames += sim.stepUntilRest();
+                potted += (int)sim.shotPocketed.size();
+                if (sim.activeObjectBalls() == 0) sim.reset();
+            }
+            ns = std::min(ns, (NowNs() - t0) / frames);
+        }
+        printf("table %-8s balls=%2d pockets=%d  %5.0f ns/frame  %5.1f frames/shot  potted %d\n",
+               name, L.config.balls, L.config.pockets, ns, (double)frames / SHOTS, potted);
+    }
+}
+
+int main(int argc, char **argv) {
+    long rays = 20000;
+    int balls = 1024;
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    int tables = 256;
+    bool suite = false;
+    const char *jsonPath = nullptr, *baselinePath = nullptr;
+    double tolerance = 10.0;
+    bool acceptChanged = false;
+    SuiteOptions opt;
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i], "--rays") && i+1 < argc) rays = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--balls") && i+1 < argc) balls = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i+1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--tables") && i+1 < argc) tables = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--suite")) suite = true;
+        else if (!strcmp(argv[i], "--json") && i+1 < argc) jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && i+1 < argc) baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && i+1 < argc) tolerance = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--accept-changed")) acceptChanged = true;
+        else if (!strcmp(argv[i], "--reps") && i+1 < argc) opt.reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && i+1 < argc) opt.warmup = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--rays N] [--balls N] [--threads N] [--tables N]\n"
+                            "       %s --suite [--json FILE] [--baseline FILE] [--tolerance PCT] [--accept-changed] [--reps N] [--warmup N]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (rays <= 0 || balls <= 0 || threads <= 0 || tables <= 0) { fprintf(stderr, "--rays, --balls, --threads and --tables must be positive\n"); return 1; }
+    if (opt.reps <= 0 || opt.warmup < 0 || tolerance < 0.0) { fprintf(stderr, "--reps must be positive, --warmup and --tolerance not negative\n"); return 1; }
+
+    if (suite) {
+        std::vector<SuiteResult> base;
+        if (baselinePath && !ReadSuiteJson(baselinePath, base)) { fprintf(stderr, "cannot read baseline %s\n", baselinePath); return 1; }
+        std::vector<SuiteResult> results = RunSuite(opt);
+        PrintSuite(results);
+        if (jsonPath && !WriteSuiteJson(jsonPath, results, opt)) { fprintf(stderr, "cannot write %s\n", jsonPath); return 1; }
+        if (baselinePath) {
+            int failures = CompareSuite(results, base, tolerance, acceptChanged);
+            if (failures > 0) { printf("%d scenario(s) regressed over %.0f%%, changed or missing\n", failures, tolerance); return 2; }
+        }
+        return 0;
+    }
+    BenchRaycast(rays);
+    BenchKernels(balls);
+    BenchShotSearch(threads);
+    BenchEnv(tables, threads);
+    BenchSnapshot();
+    BenchBreak();
+    BenchCutAngle();
+    BenchTables();
+    return 0;
+}
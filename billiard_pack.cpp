@@ -0,0 +1,27 @@
+// Packs assets/ into assets/assets.bundle: the ball atlas, cue and font glyph
+// atlas pre-decoded to RGBA so the game maps them instead of decoding PNG/TTF.
+// Uses raylib's image/font code only, no window.
+// g++ -O2 billiard_pack.cpp game_assets.cpp -o billiard_pack -lraylib -lm -lpthread -ldl -lGL
+// ./billiard_pack [assets/]
+
+#include "game_assets.h"
+#include <cstdio>
+
+int main(int argc, char **argv) {
+    std::string dir = argc > 1 ? argv[1] : "assets/";
+    if (!dir.empty() && dir.back() != '/') dir += '/';
+    SetTraceLogLevel(LOG_WARNING);
+
+    DecodedAssets d;
+    DecodeAssetSources(dir, d);
+    int balls = 0;
+    for (int i=0;i<16;i++) if (d.ballHas[i]) balls++;
+    printf("decoded:  %d balls, cue %s, font %zu glyphs in %.1f ms\n", balls, d.cue.data ? "yes" : "no", d.glyphs.size(), d.decodeMs);
+
+    std::string out = dir + "assets.bundle";
+    if (!WriteAssetBundle(out, d)) { fprintf(stderr, "cannot write %s\n", out.c_str()); return 1; }
+    DecodedAssets check;
+    if (!MapAssetBundle(out, check)) { fprintf(stderr, "%s does not read back\n", out.c_str()); return 1; }
+    printf("written:  %s (%zu bytes), maps in %.3f ms\n", out.c_str(), check.mappingSize, check.decodeMs);
+    return 0;
+}
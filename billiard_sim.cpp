@@ -0,0 +1,481 @@
+// Headless shot runner - no window, no raylib needed.
+// g++ -O2 billiard_sim.cpp table_sim.cpp contact_solver.cpp table_events.cpp table_query.cpp ball_soa.cpp game_rules.cpp replay.cpp thread_pool.cpp shot_ai.cpp table_hash.cpp tournament.cpp game_snapshot.cpp net_play.cpp table_wall.cpp profiler.cpp alloc_check.cpp -o billiard_sim -lpthread
+// ./billiard_sim [--shots N] [--seed S] [--table NAME] [--engine step|event|soa] [--kernels scalar|sse2|avx2]
+// ./billiard_sim --stress BALLS [--frames F] [--broadphase grid|none]
+// ./billiard_sim --record FILE [--seed S] [--keyframes N]  |  --replay FILE
+// ./billiard_sim --tournament GAMES [--p1 NAME] [--p2 NAME] [--threads N] [--out FILE] [--seed S]
+// ./billiard_sim --net-test GAMES [--latency MS] [--jitter MS] [--loss PCT] [--seed S]
+// ./billiard_sim --wall TABLES [--frames F] [--p1 NAME] [--p2 NAME] [--threads N] [--seed S]
+// Built with -DBILLIARD_ALLOC_CHECK (see alloc_check.h) the shot and stress
+// loops also count heap allocations on every thread after their first shot /
+// frame (the shot loop runs computer searches too) and exit with status 3 if
+// there were any.
+
+#include "table_sim.h"
+#include "ball_soa.h"
+#include "game_rules.h"
+#include "replay.h"
+#include "tournament.h"
+#include "shot_ai.h"
+#include "net_play.h"
+#include "table_wall.h"
+#include <algorithm>
+#include "alloc_check.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+enum Engine { ENGINE_STEP, ENGINE_EVENT, ENGINE_SOA };
+
+// step() semantics on SoA storage with the SIMD kernels
+static int StepUntilRestSoA(TableSim &sim, BallSoA &soa, const SoaKernels &k, int maxSteps = 20000) {
+    soa.load(sim.balls);
+    int n = 0;
+    while (n < maxSteps && !soa.atRest()) { StepSoA(soa, sim.layout, k, sim.shotPocketed); n++; }
+    soa.store(sim.balls);
+    return n;
+}
+
+// N moving balls at 8-ball density on a proportionally bigger table
+static int RunStress(int nBalls, int frames, bool useGrid, unsigned seed) {
+    float side = sqrtf((float)nBalls / 16.0f);
+    if (side < 1.0f) side = 1.0f;
+    TableSim sim(MakeTableLayout((int)(1000 * side), (int)(650 * side), 1.0f / side));
+    sim.useGrid = useGrid;
+    const Rectangle &play = sim.layout.play;
+    const float R = sim.layout.ballR;
+
+    // jittered lattice so nothing starts overlapped
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(-0.2f*R, 0.2f*R), vel(-6.0f, 6.0f);
+    int cols = (int)(play.width / (3.0f*R)), rows = (int)(play.height / (3.0f*R));
+    if (cols * rows < nBalls) { fprintf(stderr, "--stress: %d balls do not fit\n", nBalls); return 1; }
+    sim.balls.clear();
+    for (int i=0;i<nBalls;i++) {
+        Vector2 p = { play.x + (i % cols + 0.5f) * play.width / cols + jitter(rng), play.y + (i / cols + 0.5f) * play.height / rows + jitter(rng) };
+        sim.balls.push_back({ p, { vel(rng), vel(rng) }, true, i == 0 ? 0 : 1 + (i - 1) % 15, 0 });
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+#ifdef BILLIARD_ALLOC_CHECK
+    long allocs = 0;
+    for (int f=0;f<frames;f++) {
+        long before = AllocCount();
+        sim.step();
+        if (f > 0) allocs += AllocCount() - before;   // the first step sizes the grid
+    }
+#else
+    for (int f=0;f<frames;f++) sim.step();
+#endif
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("stress:       %d balls, %d frames, broad-phase %s\n", nBalls, frames, useGrid ? "grid" : "none");
+    printf("on table:     %d\n", sim.activeObjectBalls() + 1);
+    printf("us/step:      %.2f\n", secs * 1e6 / frames);
+    printf("ns/ball-step: %.2f\n", secs * 1e9 / ((double)frames * nBalls));
+#ifdef BILLIARD_ALLOC_CHECK
+    printf("heap allocs:  %ld after the first step\n", allocs);
+    if (allocs > 0) return 3;
+#endif
+    return 0;
+}
+
+// A game of random shots run tick by tick like the window loop, with think
+// time between shots, written out as a replay.
+static int RecordGame(const char *path, unsigned seed, int keyframeEvery) {
+    const int MAX_SHOTS = 80;
+    TableSim sim(MakeTableLayout(1000, 650));
+    TurnState turn;
+    ReplayRecorder rec;
+    rec.begin(sim, GAME_SUBSTEPS, keyframeEvery);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f), powerDist(2.0f, MAX_POWER);
+    std::uniform_int_distribution<uint32_t> thinkDist(20, 400);
+
+    uint32_t tick = 0, nextShot = thinkDist(rng);
+    while (!turn.gameOver && rec.shots() < MAX_SHOTS) {
+        if (!turn.shotInProgress && tick >= nextShot) {
+            if (turn.waitingPlacement) { sim.spotCueBall(); rec.spot(tick); turn.waitingPlacement = false; }
+            float angle = angleDist(rng), power = powerDist(rng);
+            rec.shot(tick, sim, turn, angle, power);
+            sim.shoot(angle, power);
+            turn.shotInProgress = true;
+            turn.slowTimer = 0.0f;
+        }
+        RulesTick(sim, turn, GAME_SUBSTEPS, GAME_TICK_DT);
+        tick++;
+        if (turn.shotInProgress) nextShot = tick + thinkDist(rng);
+    }
+    const std::vector<uint8_t> &bytes = rec.finish(tick, sim, turn);
+    if (!SaveReplay(path, bytes)) { fprintf(stderr, "cannot write %s\n", path); return 1; }
+    printf("recorded:     %s\n", path);
+    printf("shots:        %d over %u ticks (%.0f s of play)\n", rec.shots(), tick, tick / 60.0);
+    printf("score:        P1 %d  P2 %d%s\n", turn.score[1], turn.score[2], turn.gameOver ? "  (8 down)" : "");
+    printf("bytes:        %zu\n", bytes.size());
+    return 0;
+}
+
+// Copies of a replay with single bytes overwritten: each must be rejected by
+// load() or end within one capped gap of the original and play from a state
+// the game could be in. (Build with
+// -fsanitize=address,undefined to see that none of them reads or writes out
+// of bounds either.)
+static bool DamagedCopiesSane(const std::vector<uint8_t> &bytes, uint32_t end, int &tried, int &rejected) {
+    ReplayPlayer player(MakeTableLayout(1000, 650));
+    std::vector<uint8_t> copy;
+    bool sane = true;
+    const size_t stride = std::max<size_t>(1, bytes.size() / 200);
+    for (size_t i=0; i<bytes.size(); i+=stride)
+        for (uint8_t v : { 0x00, 0xc8, 0xff }) {
+            if (bytes[i] == v) continue;
+            copy = bytes;
+            copy[i] = v;
+            tried++;
+            if (!player.load(copy)) { rejected++; continue; }
+            // one byte can stretch at most one gap, and load() caps every gap
+            if (player.endTick() > end + REPLAY_MAX_GAP) { sane = false; continue; }
+            // the start is enough: keyframes were checked by load()
+            player.seek(std::min(player.endTick(), std::min(end, 600u)));
+            const TurnState &turn = player.turn;
+            if (turn.currentPlayer < 1 || turn.currentPlayer > 2 || turn.winner < -1 || turn.winner > 2 ||
+                player.sim.balls.empty() || player.sim.balls[0].id != 0) sane = false;
+        }
+    return sane;
+}
+
+static int PlayReplay(const char *path) {
+    std::vector<uint8_t> bytes;
+    if (!LoadReplay(path, bytes)) { fprintf(stderr, "cannot read %s\n", path); return 1; }
+    ReplayPlayer player(MakeTableLayout(1000, 650));
+    std::string error;
+    if (!player.load(bytes, &error)) { fprintf(stderr, "%s: %s\n", path, error.c_str()); return 1; }
+    const uint32_t end = player.endTick();
+
+    auto t0 = std::chrono::steady_clock::now();
+    player.seek(end);
+    double playSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    bool ok = player.matchesRecording();
+
+    // with keyframes cached by the first pass, seeking anywhere is short
+    auto t1 = std::chrono::steady_clock::now();
+    player.seek(end / 3);
+    player.seek(end / 2);
+    player.seek(end);
+    double seekSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+    ok = ok && player.matchesRecording();
+
+    printf("replay:       %s (%zu bytes, %zu shots)\n", path, bytes.size(), player.shots());
+    printf("ticks:        %u (%.0f s of play)\n", end, end / 60.0);
+    printf("score:        P1 %d  P2 %d\n", player.turn.score[1], player.turn.score[2]);
+    printf("full replay:  %.2f ms (%.0fx real time)\n", playSecs * 1e3, (end / 60.0) / playSecs);
+    printf("3 seeks:      %.2f ms\n", seekSecs * 1e3);
+    printf("verified:     %s\n", ok ? "yes" : "NO - final table differs from the recording");
+
+    int tried = 0, rejected = 0;
+    bool sane = DamagedCopiesSane(bytes, end, tried, rejected);
+    printf("damaged:      %d corrupted copies, %d rejected, %s\n", tried, rejected,
+           sane ? "the rest play from a legal state" : "SOME LOADED AN IMPOSSIBLE STATE");
+    return ok && sane ? 0 : 2;
+}
+
+static int PlayTournament(long games, const char *nameA, const char *nameB, int threads, const char *outPath, unsigned seed) {
+    const ScriptedPlayer *a = FindScriptedPlayer(nameA), *b = FindScriptedPlayer(nameB);
+    if (!a || !b) { fprintf(stderr, "unknown player %s (have %s)\n", a ? nameB : nameA, ScriptedPlayerNames().c_str()); return 1; }
+    FILE *out = nullptr;
+    if (outPath && !(out = fopen(outPath, "w"))) { fprintf(stderr, "cannot write %s\n", outPath); return 1; }
+    TournamentStats st = RunTournament(*a, *b, games, threads, seed, out);
+    if (out) fclose(out);
+
+    double n = (double)st.games;
+    printf("tournament:   %ld games, A = %s, B = %s (A breaks the even games)\n", st.games, a->name, b->name);
+    printf("wins:         A %.1f%%  B %.1f%%  draws %.1f%% (%d-shot limit)\n", 100.0 * st.wins[0] / n, 100.0 * st.wins[1] / n, 100.0 * st.draws / n, TOURNAMENT_MAX_SHOTS);
+    printf("shots/game:   %.1f (A %.1f, B %.1f)\n", (st.shots[0] + st.shots[1]) / n, st.shots[0] / n, st.shots[1] / n);
+    printf("fouls/shot:   A %.3f  B %.3f\n", st.shots[0] ? (double)st.fouls[0] / st.shots[0] : 0.0, st.shots[1] ? (double)st.fouls[1] / st.shots[1] : 0.0);
+    printf("wall time:    %.3f s\n", st.seconds);
+    printf("games/sec:    %.1f\n", n / st.seconds);
+    if (outPath) printf("results:      %s\n", outPath);
+    return 0;
+}
+
+// One side of a loopback network game: its own table, socket and recording.
+struct NetPeer {
+    TableSim sim;
+    TurnState turn;
+    NetLink link;
+    ReplayRecorder rec;
+    NetSession net;
+    bool started = false;
+    uint32_t readyAt = 0;   // tick this side plays at; 0 while it is not its move
+
+    explicit NetPeer(int seat) : sim(MakeTableLayout(1000, 650)), net(link, seat, sim, turn, 2, &rec) {}
+};
+
+static bool ReplayVerifies(NetPeer &p) {
+    ReplayPlayer player(p.sim.layout);
+    if (!player.load(p.rec.finish(p.net.tick(), p.sim, p.turn))) return false;
+    player.seek(player.endTick());
+    return player.matchesRecording();
+}
+
+// Two networked sides over localhost UDP, both in this process on one virtual
+// 60 Hz clock, with latency, jitter and loss injected on every datagram. Both
+// play the aim script on their own turns, with some think time.
+static int RunNetTest(long games, double latencyMs, double jitterMs, double lossPct, unsigned seed) {
+    const ScriptedPlayer &player = *FindScriptedPlayer("aim");
+    const double FRAME_MS = 1000.0 / 60.0;
+    const long MAX_FRAMES = 60L * 60 * 30;   // half an hour of play
+    long finished = 0, inputs = 0, divergences = 0, finalMismatches = 0, tooLate = 0, badReplays = 0;
+    long rollbacks = 0, resimTicks = 0, inputBytes = 0, wireBytes = 0, packets = 0, dropped = 0;
+    double playedMs = 0.0;
+    std::vector<double> latencies;
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (long g=0; g<games; g++) {
+        NetPeer a(1), b(2);   // a hosts, b joins
+        if (!a.link.open(0) || !b.link.open(0) || !b.link.connect("127.0.0.1", a.link.localPort())) {
+            fprintf(stderr, "cannot open UDP sockets on localhost\n");
+            return 1;
+        }
+        a.link.impair(latencyMs, jitterMs, lossPct, seed * 7919u + (unsigned)g * 2);
+        b.link.impair(latencyMs, jitterMs, lossPct, seed * 7919u + (unsigned)g * 2 + 1);
+        std::mt19937 rng(seed + (unsigned)g);
+        std::uniform_int_distribution<uint32_t> think(20, 120);
+        NetPeer *peers[2] = { &a, &b };
+
+        long frame = 0;
+        for (; frame<MAX_FRAMES && !(a.turn.gameOver && b.turn.gameOver); frame++) {
+            const double nowMs = frame * FRAME_MS;
+            for (NetPeer *p : peers) {
+                p->net.update(nowMs);
+                if (!p->started && p->net.connected()) { p->net.begin(); p->started = true; }
+            }
+            for (NetPeer *p : peers) {
+                if (!p->started || !p->net.localTurn() || p->turn.shotInProgress) { p->readyAt = 0; continue; }
+                if (p->readyAt == 0) p->readyAt = p->net.tick() + think(rng);
+                if (p->net.tick() < p->readyAt) continue;
+                p->readyAt = 0;
+                if (p->turn.waitingPlacement) {
+                    if (!p->net.place(ChooseCuePlacement(p->sim))) p->net.spot();
+                    continue;
+                }
+                float angle, power;
+                player.shot(p->sim, rng, angle, power);
+                p->net.shoot(angle, power);
+            }
+            for (NetPeer *p : peers) if (p->started) p->net.stepTick();
+        }
+
+        playedMs += frame * FRAME_MS;
+        if (a.turn.gameOver && b.turn.gameOver) finished++;
+        if (a.net.tick() != b.net.tick() || ReplayChecksum(a.sim, a.turn) != ReplayChecksum(b.sim, b.turn)) finalMismatches++;
+        for (NetPeer *p : peers) {
+            const NetStats &st = p->net.stats();
+            inputs += st.inputsSent;
+            divergences += st.divergences;
+            tooLate += st.tooLate;
+            rollbacks += st.rollbacks;
+            resimTicks += st.resimTicks;
+            inputBytes += st.inputBytes;
+            wireBytes += p->link.bytesSent;
+            packets += p->link.packetsSent;
+            dropped += p->link.packetsDropped;
+            if (!ReplayVerifies(*p)) badReplays++;
+        }
+        // input made on one side to first drawn on the other
+        for (int s=0;s<2;s++) {
+            const std::vector<double> &made = peers[s]->net.localMadeMs(), &shown = peers[1-s]->net.remoteShownMs();
+            for (size_t k=0; k<made.size() && k<shown.size(); k++) if (shown[k] >= 0.0) latencies.push_back(shown[k] - made[k]);
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    double avgLatency = 0.0;
+    for (double l : latencies) avgLatency += l;
+    if (!latencies.empty()) avgLatency /= latencies.size();
+    auto pct = [&](double p) { return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))]; };
+    long lost = inputs - (long)latencies.size();
+
+    printf("net test:     %ld games over localhost UDP, latency %.0f +- %.0f ms, loss %.1f%%\n", games, latencyMs, jitterMs, lossPct);
+    printf("finished:     %ld (%ld inputs)\n", finished, inputs);
+    printf("divergence:   %ld hash mismatches, %ld final tables differ, %ld inputs too late, %ld replays fail\n",
+           divergences, finalMismatches, tooLate, badReplays);
+    printf("rollbacks:    %ld (%.1f ticks re-simulated each)\n", rollbacks, rollbacks ? (double)resimTicks / rollbacks : 0.0);
+    printf("latency:      input to display avg %.1f ms, p50 %.1f, p99 %.1f, max %.1f%s\n", avgLatency, pct(0.5), pct(0.99),
+           latencies.empty() ? 0.0 : latencies.back(), lost > 0 ? " (some never shown)" : "");
+    printf("bandwidth:    %.1f bytes per input; %.0f bytes/s per side on the wire with acks, resends and keepalives\n",
+           inputs ? (double)inputBytes / inputs : 0.0, playedMs > 0.0 ? wireBytes / (2.0 * playedMs * 1e-3) : 0.0);
+    printf("packets:      %ld sent, %ld dropped\n", packets, dropped);
+    printf("wall time:    %.3f s\n", secs);
+    bool ok = divergences == 0 && finalMismatches == 0 && tooLate == 0 && badReplays == 0 && finished == games;
+    return ok ? 0 : 2;
+}
+
+// The spectator wall's simulation side without a window: every table ticked
+// once per frame on the pool, timed against a 60 Hz frame.
+static int RunWall(int tables, int frames, const char *p1Name, const char *p2Name, int threads, unsigned seed) {
+    const ScriptedPlayer *p1 = FindScriptedPlayer(p1Name), *p2 = FindScriptedPlayer(p2Name);
+    if (!p1 || !p2) { fprintf(stderr, "players: %s\n", ScriptedPlayerNames().c_str()); return 1; }
+    const double FRAME_MS = 1000.0 / 60.0;
+    TableWall wall(MakeTableLayout(1000, 650), tables, threads, *p1, *p2, seed);
+    std::vector<double> tickMs;
+    tickMs.reserve(frames);
+    long moving = 0;
+    for (int f=0;f<frames;f++) {
+        wall.beginTick();
+        wall.endTick();
+        tickMs.push_back(wall.tickMs);
+        for (int i=0;i<wall.size();i++) moving += wall.view(i).moving;
+    }
+    int games = 0;
+    for (int i=0;i<wall.size();i++) games += wall.view(i).games;
+
+    std::vector<double> sorted = tickMs;
+    std::sort(sorted.begin(), sorted.end());
+    double avg = 0.0;
+    long over = 0;
+    for (double ms : tickMs) { avg += ms; if (ms > FRAME_MS) over++; }
+    avg /= frames;
+    printf("wall:         %d tables, %d frames, %d threads\n", tables, frames, wall.threads());
+    printf("in motion:    %.1f tables on average\n", (double)moving / frames);
+    printf("games:        %d finished\n", games);
+    printf("tick:         avg %.3f ms, p99 %.3f, max %.3f (frame %.1f ms)\n", avg,
+           sorted[std::min(sorted.size() - 1, (size_t)(0.99 * sorted.size()))], sorted.back(), FRAME_MS);
+    printf("over budget:  %ld ticks\n", over);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long shots = 5000;
+    unsigned seed = 1u;
+    Engine engine = ENGINE_STEP;
+    const SoaKernels *kernels = &GetSoaKernels();
+    int stressBalls = 0, stressFrames = 600;
+    bool useGrid = true;
+    const char *recordPath = nullptr, *replayPath = nullptr;
+    int keyframes = 0;
+    long tournamentGames = 0;
+    const char *p1 = "aim", *p2 = "random", *outPath = nullptr;
+    int threads = 0;
+    long netGames = 0;
+    double latencyMs = 80.0, jitterMs = 20.0, lossPct = 5.0;
+    int wallTables = 0;
+    const TableConfig *table = &TABLE_8BALL;
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i], "--shots") && i+1 < argc) shots = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i+1 < argc) seed = (unsigned)atol(argv[++i]);
+        else if (!strcmp(argv[i], "--engine") && i+1 < argc) {
+            const char *e = argv[++i];
+            engine = !strcmp(e, "event") ? ENGINE_EVENT : !strcmp(e, "soa") ? ENGINE_SOA : ENGINE_STEP;
+        }
+        else if (!strcmp(argv[i], "--kernels") && i+1 < argc) {
+            const char *k = argv[++i];
+            kernels = &GetSoaKernels(!strcmp(k, "avx2") ? KERNEL_AVX2 : !strcmp(k, "sse2") ? KERNEL_SSE2 : KERNEL_SCALAR);
+        }
+        else if (!strcmp(argv[i], "--stress") && i+1 < argc) stressBalls = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i+1 < argc) stressFrames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--broadphase") && i+1 < argc) useGrid = strcmp(argv[++i], "none") != 0;
+        else if (!strcmp(argv[i], "--record") && i+1 < argc) recordPath = argv[++i];
+        else if (!strcmp(argv[i], "--replay") && i+1 < argc) replayPath = argv[++i];
+        else if (!strcmp(argv[i], "--keyframes") && i+1 < argc) keyframes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--tournament") && i+1 < argc) tournamentGames = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--p1") && i+1 < argc) p1 = argv[++i];
+        else if (!strcmp(argv[i], "--p2") && i+1 < argc) p2 = argv[++i];
+        else if (!strcmp(argv[i], "--threads") && i+1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i+1 < argc) outPath = argv[++i];
+        else if (!strcmp(argv[i], "--net-test") && i+1 < argc) netGames = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--latency") && i+1 < argc) latencyMs = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--jitter") && i+1 < argc) jitterMs = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--loss") && i+1 < argc) lossPct = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--wall") && i+1 < argc) wallTables = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--table") && i+1 < argc) {
+            table = FindTableConfig(argv[++i]);
+            if (!table) { fprintf(stderr, "tables: %s\n", TableConfigNames().c_str()); return 1; }
+        }
+        else {
+            fprintf(stderr, "usage: %s [--shots N] [--seed S] [--table %s] [--engine step|event|soa] [--kernels scalar|sse2|avx2]\n",
+                    argv[0], TableConfigNames().c_str());
+            fprintf(stderr, "       %s --stress BALLS [--frames F] [--broadphase grid|none]\n", argv[0]);
+            fprintf(stderr, "       %s --record FILE [--seed S] [--keyframes N] | --replay FILE\n", argv[0]);
+            fprintf(stderr, "       %s --tournament GAMES [--p1 %s] [--p2 ...] [--threads N] [--out FILE] [--seed S]\n", argv[0], ScriptedPlayerNames().c_str());
+            fprintf(stderr, "       %s --net-test GAMES [--latency MS] [--jitter MS] [--loss PCT] [--seed S]\n", argv[0]);
+            fprintf(stderr, "       %s --wall TABLES [--frames F] [--p1 NAME] [--p2 NAME] [--threads N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (recordPath) return RecordGame(recordPath, seed, keyframes);
+    if (replayPath) return PlayReplay(replayPath);
+    if (tournamentGames > 0) return PlayTournament(tournamentGames, p1, p2, threads, outPath, seed);
+    if (netGames > 0) return RunNetTest(netGames, latencyMs, jitterMs, lossPct, seed);
+    if (wallTables > 0) return RunWall(wallTables, stressFrames > 0 ? stressFrames : 600, p1, p2, threads, seed);
+    if (stressBalls > 0) return RunStress(stressBalls, stressFrames > 0 ? stressFrames : 600, useGrid, seed);
+    if (shots <= 0) { fprintf(stderr, "--shots must be positive\n"); return 1; }
+
+    // laid out in the game's 1000x650 window
+    TableSim sim(MakeTableLayout(*table, 1000, 650));
+    BallSoA soa;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+    std::uniform_real_distribution<float> powerDist(2.0f, MAX_POWER);
+
+    double totalFrames = 0.0;
+    long potted = 0, scratches = 0, racks = 1;
+    auto t0 = std::chrono::steady_clock::now();
+#ifdef BILLIARD_ALLOC_CHECK
+    // The computer player searches every few shots as well, on its pool, as
+    // in the game; the count covers every thread.
+    long allocs = 0, allocsBefore = 0, searches = 0;
+    ThreadPool searchPool(2);
+    ShotCache searchCache(1 << 12);
+    AiConfig searchConfig;
+    searchConfig.budgetMs = 2.0;
+    searchConfig.cache = &searchCache;
+    ShotSearchWorker search(sim.layout, searchPool, searchConfig);
+#endif
+    for (long s = 0; s < shots; s++) {
+#ifdef BILLIARD_ALLOC_CHECK
+        // the first shot sizes the SoA buffers
+        if (s == 1) allocsBefore = AllocCount();
+        if (s % 16 == 0) {
+            AiShot ai;
+            search.start(sim);
+            while (!search.take(sim, ai)) std::this_thread::yield();
+            searches++;
+        }
+#endif
+        sim.shoot(angleDist(rng), powerDist(rng));
+        if (engine == ENGINE_EVENT) totalFrames += sim.advanceUntilRest();
+        else if (engine == ENGINE_SOA) totalFrames += StepUntilRestSoA(sim, soa, *kernels);
+        else totalFrames += sim.stepUntilRest();
+        bool rerack = false;
+        for (int id : sim.shotPocketed) {
+            if (id == 0) scratches++;
+            else potted++;
+            if (id == table->keyBall) rerack = true;
+        }
+        if (rerack || sim.activeObjectBalls() == 0) { sim.reset(); racks++; }
+    }
+#ifdef BILLIARD_ALLOC_CHECK
+    if (shots > 1) allocs = AllocCount() - allocsBefore;
+#endif
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("table:        %s (%d balls, %d pockets)\n", table->name, table->balls, table->pockets);
+    if (engine == ENGINE_SOA) printf("engine:       soa (%s kernels)\n", kernels->name);
+    else printf("engine:       %s\n", engine == ENGINE_EVENT ? "event" : "step");
+    printf("shots:        %ld\n", shots);
+    printf("racks:        %ld\n", racks);
+    printf("potted:       %ld (scratches %ld)\n", potted, scratches);
+    printf("frames/shot:  %.1f\n", totalFrames / shots);
+    if (engine == ENGINE_EVENT) printf("events/shot:  %.1f\n", (double)sim.events / shots);
+    printf("wall time:    %.3f s\n", secs);
+    printf("shots/sec:    %.0f\n", shots / secs);
+#ifdef BILLIARD_ALLOC_CHECK
+    printf("heap allocs:  %ld after the first shot (%ld computer searches, all threads)\n", allocs, searches);
+    if (allocs > 0) return 3;
+#endif
+    return 0;
+}
@@ -0,0 +1,178 @@
+// Spectator wall: a grid of tables playing on their own, for a venue screen.
+// g++ -O2 billiard_wall.cpp table_wall.cpp table_draw.cpp tournament.cpp shot_ai.cpp table_hash.cpp table_query.cpp table_sim.cpp contact_solver.cpp table_events.cpp game_rules.cpp game_snapshot.cpp replay.cpp thread_pool.cpp game_assets.cpp profiler.cpp -o billiard_wall -lraylib -lm -lpthread -ldl -lrt -lGL
+// ./billiard_wall [--tables N] [--threads N] [--p1 NAME] [--p2 NAME] [--replay FILE]... [--seed S] [--frames F]
+//
+// The simulation runs on a TableWall (table_wall.h): each frame collects the
+// tick the workers ran during the last frame and starts the next, so physics
+// overlaps drawing. Drawing is a handful of batches however many tables
+// there are: every table shares one baked background texture, every ball is
+// a sprite from the one ball atlas, and all labels come from one font.
+// --frames runs that many frames, prints frame and tick timings and exits.
+
+#include "raylib.h"
+#include "table_wall.h"
+#include "table_draw.h"
+#include "game_assets.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+const int WALL_W = 1600;
+const int WALL_H = 900;
+const int FOOTER_H = 24;
+const float GUTTER = 4.0f;
+
+int main(int argc, char **argv) {
+    int tables = 16, threads = 0, frames = 0;
+    const char *p1Name = "aim", *p2Name = "aim";
+    unsigned seed = 1u;
+    std::vector<const char *> replayPaths;
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i], "--tables") && i+1 < argc) tables = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i+1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--p1") && i+1 < argc) p1Name = argv[++i];
+        else if (!strcmp(argv[i], "--p2") && i+1 < argc) p2Name = argv[++i];
+        else if (!strcmp(argv[i], "--replay") && i+1 < argc) replayPaths.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i+1 < argc) seed = (unsigned)atol(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i+1 < argc) frames = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--tables N] [--threads N] [--p1 %s] [--p2 ...] [--replay FILE]... [--seed S] [--frames F]\n",
+                    argv[0], ScriptedPlayerNames().c_str());
+            return 1;
+        }
+    }
+    const ScriptedPlayer *p1 = FindScriptedPlayer(p1Name), *p2 = FindScriptedPlayer(p2Name);
+    if (tables <= 0 || !p1 || !p2) { fprintf(stderr, "need --tables > 0 and players from %s\n", ScriptedPlayerNames().c_str()); return 1; }
+    // leave the render thread a core of its own
+    if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+    // the game's table, so its replays load here
+    const TableLayout layout = MakeTableLayout(1000, 650);
+    TableWall wall(layout, tables, threads, *p1, *p2, seed);
+    for (const char *path : replayPaths) {
+        std::vector<uint8_t> data;
+        std::string err;
+        if (!LoadReplay(path, data) || !wall.addReplay(data, &err)) {
+            fprintf(stderr, "%s: %s\n", path, err.empty() ? "cannot read" : err.c_str());
+            return 1;
+        }
+    }
+
+    // the column count that gives the biggest tiles
+    const float layoutW = 1000.0f, layoutH = 650.0f;
+    int cols = 1;
+    float tileScale = 0.0f;
+    for (int c=1;c<=tables;c++) {
+        int rows = (tables + c - 1) / c;
+        float s = std::min((WALL_W - GUTTER*(c + 1)) / (c * layoutW), (WALL_H - FOOTER_H - GUTTER*(rows + 1)) / (rows * layoutH));
+        if (s > tileScale) { tileScale = s; cols = c; }
+    }
+    const int rows = (tables + cols - 1) / cols;
+    const int tileW = (int)ceilf(layoutW * tileScale), tileH = (int)ceilf(layoutH * tileScale);
+    const float gridX = (WALL_W - cols*tileW - GUTTER*(cols - 1)) * 0.5f;
+    const float gridY = (WALL_H - FOOTER_H - rows*tileH - GUTTER*(rows - 1)) * 0.5f;
+    std::vector<Vector2> cell(tables);
+    for (int i=0;i<tables;i++) cell[i] = { floorf(gridX + (i % cols) * (tileW + GUTTER)), floorf(gridY + (i / cols) * (tileH + GUTTER)) };
+    const float ballR = layout.ballR * tileScale;
+
+    SetConfigFlags(FLAG_MSAA_4X_HINT);
+    InitWindow(WALL_W, WALL_H, "8 Ball Pool - wall");
+    SetTargetFPS(60);
+
+    DecodedAssets decoded;
+    DecodeAssets("assets/", decoded);
+    GameAssets assets = UploadAssets(decoded);
+    decoded.release();
+    Font font = assets.font.texture.id != 0 ? assets.font : GetFontDefault();
+    const bool sprites = assets.ballAtlas.id != 0;
+    if (sprites) SetTextureFilter(assets.ballAtlas, TEXTURE_FILTER_BILINEAR);
+
+    // one background for every tile
+    RenderTexture2D tile = LoadRenderTexture(tileW, tileH);
+    BeginTextureMode(tile);
+    ClearBackground(DARKGREEN);
+    TableView tileView;
+    tileView.scale = tileScale;
+    DrawTableBackground(layout, tileView);
+    EndTextureMode();
+    SetTextureFilter(tile.texture, TEXTURE_FILTER_BILINEAR);
+
+    const double FRAME_MS = 1000.0 / 60.0;
+    std::vector<double> frameMs, simMs;
+    frameMs.reserve(frames > 0 ? frames : 0);
+    simMs.reserve(frames > 0 ? frames : 0);
+    const float labelSize = std::max(10.0f, 44.0f * tileScale);
+
+    wall.beginTick();
+    for (int f=0; !WindowShouldClose() && (frames <= 0 || f < frames); f++) {
+        // the tick the workers ran while the last frame drew
+        wall.endTick();
+        wall.beginTick();
+
+        BeginDrawing();
+        ClearBackground((Color){24,24,28,255});
+
+        // tiles: one texture, one batch; colour copied straight over
+        BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+        for (int i=0;i<tables;i++) DrawTextureRec(tile.texture, { 0, 0, (float)tileW, -(float)tileH }, cell[i], WHITE);
+        EndBlendMode();
+
+        // balls: all sprites from the one atlas, one batch
+        for (int i=0;i<tables;i++) {
+            const WallTableView &v = wall.view(i);
+            for (int k=0;k<v.count;k++) {
+                const Ball &b = v.balls[k];
+                if (!b.active) continue;
+                Vector2 p = { cell[i].x + b.pos.x*tileScale, cell[i].y + b.pos.y*tileScale };
+                if (sprites && assets.ballHas[b.id]) {
+                    DrawTexturePro(assets.ballAtlas, assets.ballSrc[b.id], { p.x, p.y, ballR*2.0f, ballR*2.0f }, { ballR, ballR }, 0.0f, WHITE);
+                } else {
+                    DrawCircleV(p, ballR, BallColor(b.id));
+                }
+            }
+        }
+
+        // labels: one font, one batch
+        for (int i=0;i<tables;i++) {
+            const WallTableView &v = wall.view(i);
+            const char *label = v.replay ? TextFormat("%d  replay", i + 1)
+                                         : TextFormat("%d  P1 %d - %d P2%s", i + 1, v.score[1], v.score[2], v.gameOver ? "" : (v.currentPlayer == 1 ? "  <" : "  >"));
+            DrawTextEx(font, label, { cell[i].x + 4.0f, cell[i].y + 2.0f }, labelSize, 1.0f, v.gameOver ? GOLD : RAYWHITE);
+        }
+        int moving = 0;
+        for (int i=0;i<tables;i++) moving += wall.view(i).moving;
+        DrawTextEx(font, TextFormat("%d tables (%d in play) on %d threads   %d FPS   sim %.2f ms/tick", tables, moving, wall.threads(), GetFPS(), wall.tickMs),
+                   { 8.0f, (float)(WALL_H - FOOTER_H + 4) }, 16.0f, 1.0f, LIGHTGRAY);
+        EndDrawing();
+
+        if (frames > 0 && f > 0) {   // the first frame includes start-up
+            frameMs.push_back(GetFrameTime() * 1000.0);
+            simMs.push_back(wall.tickMs);
+        }
+    }
+    wall.endTick();
+
+    if (!frameMs.empty()) {
+        std::vector<double> sorted = frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        double avg = 0.0, simAvg = 0.0;
+        long late = 0;
+        for (double ms : frameMs) { avg += ms; if (ms > FRAME_MS * 1.5) late++; }
+        for (double ms : simMs) simAvg += ms;
+        avg /= frameMs.size();
+        simAvg /= simMs.size();
+        printf("wall:     %d tables (%dx%d), %d threads, %zu frames\n", tables, cols, rows, wall.threads(), frameMs.size());
+        printf("frame:    avg %.2f ms, p99 %.2f, max %.2f; %ld late (> %.1f ms)\n", avg,
+               sorted[std::min(sorted.size() - 1, (size_t)(0.99 * sorted.size()))], sorted.back(), late, FRAME_MS * 1.5);
+        printf("sim:      avg %.3f ms/tick\n", simAvg);
+    }
+
+    UnloadRenderTexture(tile);
+    UnloadAssets(assets);
+    CloseWindow();
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include "contact_solver.h"
+#include "table_sim.h"
+#include <algorithm>
+
+void ContactSolver::reserve(int balls, size_t pairs) {
+    size_t contacts = pairs / 2 + 1;
+    for (auto *v : { &ia, &ib, &prevA, &prevB }) if (v->capacity() < contacts) v->reserve(contacts);
+    for (auto *v : { &nx, &ny, &gap, &lambda, &share, &prevLambda }) if (v->capacity() < contacts) v->reserve(contacts);
+    if (resting.capacity() < contacts) resting.reserve(contacts);
+    if ((int)dvx.size() < balls) { dvx.resize(balls); dvy.resize(balls); degree.resize(balls); }
+    if (moved.capacity() < (size_t)balls) moved.reserve(balls);
+}
+
+// Most frames nothing touches, so the contact list stays empty unless some
+// pair is live (an impact: touching and closing).
+static bool AnyLive(const ContactBodies &b, const std::vector<int> &pairs, float r, float maxGap, bool speculative) {
+    for (size_t p=0; p<pairs.size(); p+=2) {
+        int i = pairs[p], j = pairs[p+1];
+        float dx = b.x[j] - b.x[i], dy = b.y[j] - b.y[i];
+        float dvx = b.vx[j] - b.vx[i], dvy = b.vy[j] - b.vy[i];
+        if (speculative) { if (ContactLive(dx, dy, dvx, dvy, r)) return true; continue; }
+        float d2 = dx*dx + dy*dy;
+        if (d2 > 1e-12f && sqrtf(d2) - 2.0f*r <= maxGap && dvx*dx + dvy*dy < 0.0f) return true;
+    }
+    return false;
+}
+
+void ContactSolver::gather(const ContactBodies &b, const std::vector<int> &pairs, float r, float maxGap, bool speculative) {
+    if ((int)dvx.size() < b.count) reserve(b.count, pairs.size());
+    ia.clear(); ib.clear(); nx.clear(); ny.clear(); gap.clear();
+    moved.assign(b.count, 0);
+    if (!AnyLive(b, pairs, r, maxGap, speculative)) { lambda.clear(); share.clear(); resting.clear(); return; }
+    // Impulses only share out speed the balls already have, so a pair
+    // further apart than two of those cannot meet this frame.
+    float vmax2 = 0.0f;
+    for (int i=0; i<b.count; i++) vmax2 = fmaxf(vmax2, b.vx[i]*b.vx[i] + b.vy[i]*b.vy[i]);
+    const float reach = 2.0f*r + fminf(maxGap, 2.0f*sqrtf(vmax2));
+    for (size_t p=0; p<pairs.size(); p+=2) {
+        int i = pairs[p], j = pairs[p+1];
+        float dx = b.x[j] - b.x[i], dy = b.y[j] - b.y[i];
+        float d2 = dx*dx + dy*dy;
+        if (d2 <= 1e-12f || d2 > reach*reach) continue;
+        float d = sqrtf(d2);
+        ia.push_back(i); ib.push_back(j);
+        nx.push_back(dx / d); ny.push_back(dy / d);
+        gap.push_back(d - 2.0f*r);
+    }
+    lambda.assign(ia.size(), 0.0f);
+    share.resize(ia.size());
+    resting.assign(ia.size(), 0);
+}
+
+// adds each ball's summed dv and clears it
+void ContactSolver::applyVelocities(const ContactBodies &b) {
+    for (size_t k=0; k<ia.size(); k++)
+        for (int i : { ia[k], ib[k] }) {
+            if (dvx[i] == 0.0f && dvy[i] == 0.0f) continue;
+            b.vx[i] += dvx[i]; b.vy[i] += dvy[i];
+            dvx[i] = dvy[i] = 0.0f;
+            moved[i] = 1;
+        }
+}
+
+// Whether a pair apart (j minus i, gap > 0) touches within the next frame,
+// and if so the centre-line normal at the moment it does. The bounce must
+// go along that normal: the line between the centres while they are still
+// apart is off by as much as the cue ball travels before it arrives.
+static bool ImpactNormal(float dx, float dy, float dvx, float dvy, float r, float &outX, float &outY) {
+    float a = dvx*dvx + dvy*dvy, h = dvx*dx + dvy*dy;
+    if (h >= 0.0f || a <= 1e-12f) return false;
+    float disc = h*h - a*(dx*dx + dy*dy - 4.0f*r*r);
+    if (disc < 0.0f) return false;
+    float t = (-h - sqrtf(disc)) / a;
+    if (t > 1.0f) return false;
+    outX = (dx + dvx*t) / (2.0f*r); outY = (dy + dvy*t) / (2.0f*r);
+    return true;
+}
+
+// One Jacobi restitution pass; returns the number of closing contacts.
+int ContactSolver::impactPass(const ContactBodies &b, float r, bool speculative) {
+    const size_t n = ia.size();
+    int closing = 0;
+    for (size_t k=0; k<n; k++) { degree[ia[k]] = 0; degree[ib[k]] = 0; }
+    // relative normal velocity, negative when closing
+    for (size_t k=0; k<n; k++) {
+        float dvxk = b.vx[ib[k]] - b.vx[ia[k]], dvyk = b.vy[ib[k]] - b.vy[ia[k]];
+        share[k] = 0.0f;
+        if (speculative && gap[k] > 0.0f) {
+            float dx = b.x[ib[k]] - b.x[ia[k]], dy = b.y[ib[k]] - b.y[ia[k]];
+            if (!ImpactNormal(dx, dy, dvxk, dvyk, r, nx[k], ny[k])) continue;
+        }
+        float vn = dvxk*nx[k] + dvyk*ny[k];
+        share[k] = vn < 0.0f ? vn : 0.0f;
+        if (share[k] != 0.0f) { degree[ia[k]]++; degree[ib[k]]++; closing++; }
+    }
+    if (!closing) return 0;
+    // each contact's bounce, split over both balls' contacts
+    for (size_t k=0; k<n; k++)
+        if (share[k] != 0.0f) share[k] *= -(1.0f + RESTITUTION) / (float)(degree[ia[k]] + degree[ib[k]]);
+    for (size_t k=0; k<n; k++) {
+        if (share[k] == 0.0f) continue;
+        float jx = share[k]*nx[k], jy = share[k]*ny[k];
+        dvx[ia[k]] -= jx; dvy[ia[k]] -= jy;
+        dvx[ib[k]] += jx; dvy[ib[k]] += jy;
+    }
+    applyVelocities(b);
+    passesRun++;
+    return closing;
+}
+
+// Non-negative accumulated impulses holding every touching (or about to
+// touch) pair at no more than its gap's worth of closing per frame.
+void ContactSolver::contactPhase(const ContactBodies &b) {
+    const size_t n = ia.size();
+    for (size_t k=0; k<n; k++) { degree[ia[k]] = 0; degree[ib[k]] = 0; }
+    int count = 0;
+    for (size_t k=0; k<n; k++) {
+        float vn = (b.vx[ib[k]] - b.vx[ia[k]])*nx[k] + (b.vy[ib[k]] - b.vy[ia[k]])*ny[k];
+        resting[k] = gap[k] < 0.0f || vn < -gap[k];
+        if (resting[k]) { degree[ia[k]]++; degree[ib[k]]++; count++; }
+    }
+
+    // warm start: the same pair's impulse from the last step (both lists are in pair order)
+    size_t p = 0;
+    for (size_t k=0; k<n && warmStart > 0.0f; k++) {
+        while (p < prevA.size() && (prevA[p] < ia[k] || (prevA[p] == ia[k] && prevB[p] < ib[k]))) p++;
+        if (p == prevA.size()) break;
+        if (!resting[k] || prevA[p] != ia[k] || prevB[p] != ib[k]) continue;
+        lambda[k] = prevLambda[p] * warmStart;
+        float jx = lambda[k]*nx[k], jy = lambda[k]*ny[k];
+        dvx[ia[k]] -= jx; dvy[ia[k]] -= jy;
+        dvx[ib[k]] += jx; dvy[ib[k]] += jy;
+    }
+    applyVelocities(b);
+
+    for (int pass=0; pass<contactPasses && count > 0; pass++) {
+        float worst = 0.0f;
+        for (size_t k=0; k<n; k++) {
+            if (!resting[k]) continue;
+            float vn = (b.vx[ib[k]] - b.vx[ia[k]])*nx[k] + (b.vy[ib[k]] - b.vy[ia[k]])*ny[k];
+            float target = -fmaxf(gap[k], 0.0f);
+            float next = fmaxf(0.0f, lambda[k] + (target - vn) / (float)(degree[ia[k]] + degree[ib[k]]));
+            share[k] = next - lambda[k];
+            lambda[k] = next;
+            worst = fmaxf(worst, fabsf(share[k]));
+        }
+        if (worst < 1e-5f) break;
+        for (size_t k=0; k<n; k++) {
+            if (!resting[k] || share[k] == 0.0f) continue;
+            float jx = share[k]*nx[k], jy = share[k]*ny[k];
+            dvx[ia[k]] -= jx; dvy[ia[k]] -= jy;
+            dvx[ib[k]] += jx; dvy[ib[k]] += jy;
+        }
+        applyVelocities(b);
+        passesRun++;
+    }
+
+    forget();
+    for (size_t k=0; k<n; k++) if (lambda[k] > 0.0f) addWarm(ia[k], ib[k], lambda[k]);
+}
+
+// Jacobi push-out: each overlapping pair wants its overlap split between its
+// balls; a ball in several sums its shares of them.
+void ContactSolver::overlapPhase(const ContactBodies &b, float r) {
+    const size_t n = ia.size();
+    for (int pass=0; pass<overlapPasses; pass++) {
+        for (size_t k=0; k<n; k++) { degree[ia[k]] = 0; degree[ib[k]] = 0; }
+        int count = 0;
+        for (size_t k=0; k<n; k++) {
+            float dx = b.x[ib[k]] - b.x[ia[k]], dy = b.y[ib[k]] - b.y[ia[k]];
+            float d = sqrtf(dx*dx + dy*dy);
+            share[k] = 0.0f;
+            if (d <= 1e-6f || d >= 2.0f*r - 1e-3f) continue;
+            nx[k] = dx / d; ny[k] = dy / d;
+            share[k] = 2.0f*r - d;
+            degree[ia[k]]++; degree[ib[k]]++; count++;
+        }
+        if (!count) break;
+        for (size_t k=0; k<n; k++) {
+            if (share[k] == 0.0f) continue;
+            float s = share[k] / (float)(degree[ia[k]] + degree[ib[k]]);
+            dvx[ia[k]] -= s*nx[k]; dvy[ia[k]] -= s*ny[k];
+            dvx[ib[k]] += s*nx[k]; dvy[ib[k]] += s*ny[k];
+        }
+        // dv holds position corrections here
+        for (size_t k=0; k<n; k++)
+            for (int i : { ia[k], ib[k] }) {
+                if (dvx[i] == 0.0f && dvy[i] == 0.0f) continue;
+                b.x[i] += dvx[i]; b.y[i] += dvy[i];
+                dvx[i] = dvy[i] = 0.0f;
+                moved[i] = 1;
+            }
+        passesRun++;
+    }
+}
+
+void ContactSolver::solveStep(const ContactBodies &b, const std::vector<int> &pairs, float r) {
+    gather(b, pairs, r, 1e30f, true);
+    if (ia.empty()) { forget(); return; }
+    for (int pass=0; pass<impactPasses; pass++) if (!impactPass(b, r, true)) break;
+    contactPhase(b);
+    // only the velocities have changed so far, so the overlaps are gather's
+    for (float g : gap) if (g < 0.0f) { overlapPhase(b, r); break; }
+}
+
+void ContactSolver::solveImpacts(const ContactBodies &b, const std::vector<int> &pairs, float r, float touch) {
+    gather(b, pairs, r, touch, false);
+    for (int pass=0; pass<impactPasses; pass++) if (!impactPass(b, r, false)) break;
+}
@@ -0,0 +1,98 @@
+// Simultaneous ball-ball contact resolution.
+// All the step's contacts are gathered first and solved together in Jacobi
+// passes: every contact's impulse in a pass comes from the same velocities,
+// and a ball in several contacts takes each at a share set by how many it is
+// in (mass splitting). The result does not depend on the order the pairs come
+// in, so a symmetric rack breaks symmetrically. Per step:
+//   1. impacts: restitution impulses on every closing pair, repeated while
+//      any still close, so one hit travels through a whole cluster
+//   2. contacts: accumulated non-negative impulses that leave nothing
+//      closing, warm-started from the same pair's impulse the step before
+//   3. overlap: position passes pushing overlapping balls apart
+// A pair also counts as closing when it would close its gap within the next
+// frame (a speculative contact), so fast balls bounce before they sink into
+// each other instead of being pushed out afterwards. A speculative bounce
+// goes along the line between the centres at the moment they touch, so a
+// fast cut leaves at the same angle as a slow one. Contacts are kept as
+// parallel arrays, so each pass's impulse math is a batch over plain floats.
+
+#ifndef CONTACT_SOLVER_H
+#define CONTACT_SOLVER_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Whether a pair (j minus i in position and velocity, radius r) overlaps or
+// closes its gap within the next frame: the only pairs a frame's solve can
+// start from. When no pair is live the solve does nothing.
+inline bool ContactLive(float dx, float dy, float dvx, float dvy, float r) {
+    float d2 = dx*dx + dy*dy;
+    if (d2 < 4.0f*r*r) return true;
+    float dot = dvx*dx + dvy*dy;
+    if (dot >= 0.0f) return false;
+    float d = sqrtf(d2);
+    return dot / d < 2.0f*r - d;
+}
+
+// Ball state the solver works on, as parallel arrays (BallSoA's own, or a
+// copy of TableSim's balls).
+struct ContactBodies {
+    float *x, *y, *vx, *vy;
+    int count;
+};
+
+class ContactSolver {
+public:
+    int impactPasses = 8;      // budgets per solve; passes stop early once settled
+    int contactPasses = 4;
+    int overlapPasses = 4;
+    float warmStart = 0.8f;    // share of last step's resting impulse reapplied (0 = off)
+
+    // room for `balls` and `pairs` candidate pairs, so solving never allocates
+    void reserve(int balls, size_t pairs);
+
+    // One frame step. pairs are i < j candidates in ascending order, e.g.
+    // every active pair closer than four radii.
+    void solveStep(const ContactBodies &b, const std::vector<int> &pairs, float r);
+    // An exact impact (event engine): pairs within touch of contact and
+    // closing all bounce together. Velocities only; nothing is warm-started.
+    void solveImpacts(const ContactBodies &b, const std::vector<int> &pairs, float r, float touch);
+
+    // per ball: whether the last solve changed its position or velocity
+    const std::vector<uint8_t> &touched() const { return moved; }
+
+    // What the next solveStep() warm-starts from: the last step's resting
+    // impulses, in pair order. Snapshots carry them so a restored table
+    // steps exactly as it did; forget() when the balls are moved by hand.
+    int warmCount() const { return (int)prevA.size(); }
+    void warmContact(int k, int &a, int &b, float &lambda) const { a = prevA[k]; b = prevB[k]; lambda = prevLambda[k]; }
+    // appends; pairs must come in ascending order
+    void addWarm(int a, int b, float lambda) { prevA.push_back(a); prevB.push_back(b); prevLambda.push_back(lambda); }
+    void forget() { prevA.clear(); prevB.clear(); prevLambda.clear(); }
+
+    long passesRun = 0;        // all phases, since construction (benchmarks)
+
+private:
+    // contacts, as parallel arrays
+    std::vector<int> ia, ib;
+    std::vector<float> nx, ny, gap;   // at gather time (nx, ny: at impact, once one is found)
+    std::vector<float> lambda, share;
+    std::vector<uint8_t> resting;
+    // per ball
+    std::vector<float> dvx, dvy;
+    std::vector<int> degree;
+    std::vector<uint8_t> moved;
+    // last step's resting impulses, in pair order
+    std::vector<int> prevA, prevB;
+    std::vector<float> prevLambda;
+
+    void gather(const ContactBodies &b, const std::vector<int> &pairs, float r, float maxGap, bool speculative);
+    int impactPass(const ContactBodies &b, float r, bool speculative);
+    void contactPhase(const ContactBodies &b);
+    void overlapPhase(const ContactBodies &b, float r);
+    void applyVelocities(const ContactBodies &b);
+};
+
+#endif
@@ -0,0 +1,268 @@
+#include "game_assets.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Bundle layout (little-endian):
+//   "8BAB", u32 version, u32 entry count
+//   entries: char name[16], u32 width, height, format, offset, size
+//   payloads, each 16-byte aligned
+// Images are R8G8B8A8. "ballrects" is 16 x {x,y,w,h} floats (w == 0: no
+// ball), "glyphs" is {value, offsetX, offsetY, advanceX, x, y, w, h}.
+static const uint32_t BUNDLE_VERSION = 1;
+
+struct BundleEntry {
+    char name[16];
+    uint32_t width, height, format, offset, size;
+};
+
+struct PackedGlyph {
+    int32_t value, offsetX, offsetY, advanceX;
+    float x, y, w, h;
+};
+
+void DecodedAssets::release() {
+    if (ownsPixels) {
+        if (ballAtlas.data) UnloadImage(ballAtlas);
+        if (cue.data) UnloadImage(cue);
+        if (fontAtlas.data) UnloadImage(fontAtlas);
+    }
+    if (mapping) {
+#if defined(_WIN32)
+        free(mapping);
+#else
+        munmap(mapping, mappingSize);
+#endif
+    }
+    ballAtlas = cue = fontAtlas = Image{};
+    for (int i=0;i<16;i++) ballHas[i] = false;
+    glyphs.clear();
+    glyphRecs.clear();
+    ownsPixels = true;
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+static double MsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void DecodeAssetSources(const std::string &dir, DecodedAssets &out) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // the 16 ball PNGs share one 4x4 atlas so every ball draws from one texture
+    Image ballImg[16];
+    int cell = 0;
+    for (int i=0;i<16;i++) {
+        std::string fn = dir + "ball" + std::to_string(i) + ".png";
+        // attempt load (if missing, raylib loads data==NULL)
+        ballImg[i] = LoadImage(fn.c_str());
+        out.ballHas[i] = ballImg[i].data != NULL;
+        if (out.ballHas[i]) cell = std::max(cell, std::max(ballImg[i].width, ballImg[i].height));
+    }
+    if (cell > 0) {
+        const int PAD = 2;   // keeps filtered samples from bleeding between cells
+        out.ballAtlas = GenImageColor(4*(cell + PAD), 4*(cell + PAD), BLANK);
+        for (int i=0;i<16;i++) {
+            out.ballSrc[i] = { (float)((i % 4) * (cell + PAD)), (float)((i / 4) * (cell + PAD)), 0.0f, 0.0f };
+            if (!out.ballHas[i]) continue;
+            out.ballSrc[i].width = (float)ballImg[i].width;
+            out.ballSrc[i].height = (float)ballImg[i].height;
+            ImageDraw(&out.ballAtlas, ballImg[i], { 0, 0, (float)ballImg[i].width, (float)ballImg[i].height }, out.ballSrc[i], WHITE);
+        }
+    }
+    for (int i=0;i<16;i++) if (out.ballHas[i]) UnloadImage(ballImg[i]);
+
+    out.cue = LoadImage((dir + "cue.png").c_str());
+    if (out.cue.data) ImageFormat(&out.cue, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    // the TTF exactly as LoadFont() bakes it
+    int ttfSize = 0;
+    unsigned char *ttf = LoadFileData((dir + "Purisa-BoldOblique.ttf").c_str(), &ttfSize);
+    if (ttf) {
+        GlyphInfo *glyphs = LoadFontData(ttf, ttfSize, FONT_BAKE_SIZE, NULL, FONT_BAKE_GLYPHS, FONT_DEFAULT);
+        if (glyphs) {
+            Rectangle *recs = NULL;
+            out.fontAtlas = GenImageFontAtlas(glyphs, &recs, FONT_BAKE_GLYPHS, FONT_BAKE_SIZE, FONT_BAKE_PADDING, 0);
+            ImageFormat(&out.fontAtlas, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            for (int i=0;i<FONT_BAKE_GLYPHS;i++) {
+                GlyphInfo g = glyphs[i];
+                g.image = {};
+                out.glyphs.push_back(g);
+                out.glyphRecs.push_back(recs[i]);
+            }
+            MemFree(recs);
+            UnloadFontData(glyphs, FONT_BAKE_GLYPHS);
+        }
+        UnloadFileData(ttf);
+    }
+    out.fromBundle = false;
+    out.decodeMs = MsSince(t0);
+}
+
+bool MapAssetBundle(const std::string &path, DecodedAssets &out) {
+    auto t0 = std::chrono::steady_clock::now();
+    unsigned char *base = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len <= 0) { fclose(f); return false; }
+    base = (unsigned char *)malloc((size_t)len);
+    size = (size_t)len;
+    bool ok = base && fread(base, 1, size, f) == size;
+    fclose(f);
+    if (!ok) { free(base); return false; }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    size = (size_t)st.st_size;
+    void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    base = (unsigned char *)p;
+#endif
+    out.mapping = base;
+    out.mappingSize = size;
+    out.ownsPixels = false;
+
+    uint32_t head[3];
+    if (size < sizeof(head) || memcmp(base, "8BAB", 4) != 0) return false;
+    memcpy(head, base, sizeof(head));
+    if (head[1] != BUNDLE_VERSION || sizeof(head) + (size_t)head[2] * sizeof(BundleEntry) > size) return false;
+    const BundleEntry *entries = (const BundleEntry *)(base + sizeof(head));
+    // every entry WriteAssetBundle() writes; only the cue may be empty
+    bool balls = false, ballrects = false, cue = false, font = false, glyphs = false;
+    for (uint32_t i=0;i<head[2];i++) {
+        BundleEntry e;
+        memcpy(&e, &entries[i], sizeof(e));
+        if ((uint64_t)e.offset + e.size > size) return false;
+        unsigned char *data = base + e.offset;
+        std::string name(e.name, strnlen(e.name, sizeof(e.name)));
+        // raylib only reads these images (texture uploads), never frees them
+        Image img = { data, (int)e.width, (int)e.height, 1, (int)e.format };
+        bool isImage = e.size > 0 && (uint64_t)e.size == (uint64_t)e.width * e.height * 4u && e.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        if (name == "balls" && isImage) { out.ballAtlas = img; balls = true; }
+        else if (name == "cue" && (isImage || e.size == 0)) { if (isImage) out.cue = img; cue = true; }
+        else if (name == "font" && isImage) { out.fontAtlas = img; font = true; }
+        else if (name == "ballrects" && e.size == 16 * sizeof(Rectangle)) {
+            memcpy(out.ballSrc, data, e.size);
+            for (int k=0;k<16;k++) out.ballHas[k] = out.ballSrc[k].width > 0.0f;
+            ballrects = true;
+        } else if (name == "glyphs" && e.size == FONT_BAKE_GLYPHS * sizeof(PackedGlyph)) {
+            glyphs = true;
+            for (uint32_t k=0; k + sizeof(PackedGlyph) <= e.size; k += sizeof(PackedGlyph)) {
+                PackedGlyph g;
+                memcpy(&g, data + k, sizeof(g));
+                GlyphInfo gi = { g.value, g.offsetX, g.offsetY, g.advanceX, Image{} };
+                out.glyphs.push_back(gi);
+                out.glyphRecs.push_back({ g.x, g.y, g.w, g.h });
+            }
+        }
+    }
+    // a damaged bundle falls back to the sources rather than loading half
+    if (!balls || !ballrects || !cue || !font || !glyphs) return false;
+    out.fromBundle = true;
+    out.decodeMs = MsSince(t0);
+    return true;
+}
+
+void DecodeAssets(const std::string &dir, DecodedAssets &out) {
+    if (MapAssetBundle(dir + "assets.bundle", out)) return;
+    // a damaged bundle can leave pointers into the mapping behind
+    out.release();
+    DecodeAssetSources(dir, out);
+}
+
+static uint32_t ImageBytes(const Image &img) {
+    return img.data ? (uint32_t)img.width * (uint32_t)img.height * 4u : 0u;
+}
+
+bool WriteAssetBundle(const std::string &path, const DecodedAssets &in) {
+    std::vector<PackedGlyph> glyphs;
+    for (size_t i=0;i<in.glyphs.size();i++) {
+        const GlyphInfo &g = in.glyphs[i];
+        const Rectangle &r = in.glyphRecs[i];
+        glyphs.push_back({ g.value, g.offsetX, g.offsetY, g.advanceX, r.x, r.y, r.width, r.height });
+    }
+    Rectangle rects[16];
+    for (int i=0;i<16;i++) rects[i] = in.ballHas[i] ? in.ballSrc[i] : Rectangle{ 0, 0, 0, 0 };
+
+    struct Part { const char *name; const Image *img; const void *data; uint32_t size; };
+    const Part parts[] = {
+        { "balls", &in.ballAtlas, in.ballAtlas.data, ImageBytes(in.ballAtlas) },
+        { "ballrects", nullptr, rects, (uint32_t)sizeof(rects) },
+        { "cue", &in.cue, in.cue.data, ImageBytes(in.cue) },
+        { "font", &in.fontAtlas, in.fontAtlas.data, ImageBytes(in.fontAtlas) },
+        { "glyphs", nullptr, glyphs.data(), (uint32_t)(glyphs.size() * sizeof(PackedGlyph)) },
+    };
+    const uint32_t n = sizeof(parts) / sizeof(parts[0]);
+    std::vector<BundleEntry> entries(n);
+    uint32_t offset = 12 + n * (uint32_t)sizeof(BundleEntry);
+    for (uint32_t i=0;i<n;i++) {
+        offset = (offset + 15u) & ~15u;
+        BundleEntry &e = entries[i];
+        memset(&e, 0, sizeof(e));
+        strncpy(e.name, parts[i].name, sizeof(e.name) - 1);
+        if (parts[i].img) { e.width = parts[i].img->width; e.height = parts[i].img->height; e.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8; }
+        e.offset = offset;
+        e.size = parts[i].data ? parts[i].size : 0;
+        offset += e.size;
+    }
+
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    uint32_t head[3] = { 0, BUNDLE_VERSION, n };
+    memcpy(head, "8BAB", 4);
+    bool ok = fwrite(head, sizeof(head), 1, f) == 1 && fwrite(entries.data(), sizeof(BundleEntry), n, f) == n;
+    uint32_t at = 12 + n * (uint32_t)sizeof(BundleEntry);
+    static const char zeros[16] = {};
+    for (uint32_t i=0; ok && i<n; i++) {
+        if (entries[i].offset > at) ok = fwrite(zeros, 1, entries[i].offset - at, f) == entries[i].offset - at;
+        if (ok && entries[i].size) ok = fwrite(parts[i].data, 1, entries[i].size, f) == entries[i].size;
+        at = entries[i].offset + entries[i].size;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+GameAssets UploadAssets(const DecodedAssets &in) {
+    GameAssets a;
+    if (in.ballAtlas.data) a.ballAtlas = LoadTextureFromImage(in.ballAtlas);
+    for (int i=0;i<16;i++) { a.ballSrc[i] = in.ballSrc[i]; a.ballHas[i] = in.ballHas[i] && a.ballAtlas.id != 0; }
+    if (in.cue.data) a.cue = LoadTextureFromImage(in.cue);
+    if (in.fontAtlas.data && !in.glyphs.empty()) {
+        // the same Font LoadFont() builds, glyph images left empty (text
+        // drawing only reads the atlas); UnloadFont() frees these buffers
+        int n = (int)in.glyphs.size();
+        a.font.baseSize = FONT_BAKE_SIZE;
+        a.font.glyphCount = n;
+        a.font.glyphPadding = FONT_BAKE_PADDING;
+        a.font.texture = LoadTextureFromImage(in.fontAtlas);
+        a.font.recs = (Rectangle *)MemAlloc((unsigned int)(n * sizeof(Rectangle)));
+        a.font.glyphs = (GlyphInfo *)MemAlloc((unsigned int)(n * sizeof(GlyphInfo)));
+        memcpy(a.font.recs, in.glyphRecs.data(), n * sizeof(Rectangle));
+        memcpy(a.font.glyphs, in.glyphs.data(), n * sizeof(GlyphInfo));
+    }
+    return a;
+}
+
+void UnloadAssets(GameAssets &a) {
+    if (a.ballAtlas.id != 0) UnloadTexture(a.ballAtlas);
+    if (a.cue.id != 0) UnloadTexture(a.cue);
+    if (a.font.texture.id != 0) UnloadFont(a.font);
+    a = GameAssets();
+}
@@ -0,0 +1,67 @@
+// Game textures and font: decoding (PNG/TTF sources or the packed bundle) is
+// plain CPU work that runs off the main thread; only the GPU uploads in
+// UploadAssets() need the window's GL context.
+//
+// assets/assets.bundle (written by billiard_pack) holds the ball atlas, the
+// cue and the font glyph atlas as pre-decoded RGBA plus the glyph metrics,
+// so loading it is a file mapping instead of 17 PNG decodes and a TTF
+// rasterisation.
+
+#ifndef GAME_ASSETS_H
+#define GAME_ASSETS_H
+
+#include "raylib.h"
+#include <string>
+#include <vector>
+
+const int FONT_BAKE_SIZE = 32;      // what LoadFont() used for the TTF
+const int FONT_BAKE_GLYPHS = 95;    // ASCII 32..126
+const int FONT_BAKE_PADDING = 4;
+
+struct DecodedAssets {
+    Image ballAtlas = {};           // 4x4 cells, see ballSrc
+    Rectangle ballSrc[16];
+    bool ballHas[16] = { false };
+    Image cue = {};
+    Image fontAtlas = {};
+    std::vector<GlyphInfo> glyphs;  // metrics only, no per-glyph images
+    std::vector<Rectangle> glyphRecs;
+    bool fromBundle = false;
+    double decodeMs = 0.0;
+
+    // Images decoded from sources own their pixels; bundle images point into
+    // the mapping, which lives as long as this struct.
+    bool ownsPixels = true;
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+
+    DecodedAssets() = default;
+    DecodedAssets(const DecodedAssets &) = delete;
+    DecodedAssets &operator=(const DecodedAssets &) = delete;
+    ~DecodedAssets() { release(); }
+    // frees pixels / the mapping (after UploadAssets the GPU has its copy)
+    void release();
+};
+
+struct GameAssets {
+    Texture2D ballAtlas = {};
+    Rectangle ballSrc[16];
+    bool ballHas[16] = { false };
+    Texture2D cue = {};
+    Font font = {};
+};
+
+// decode PNG/TTF files from dir (missing files just stay empty)
+void DecodeAssetSources(const std::string &dir, DecodedAssets &out);
+// map dir + "assets.bundle"; false when missing, not a bundle or any entry
+// is absent or malformed
+bool MapAssetBundle(const std::string &path, DecodedAssets &out);
+// the bundle when there is one, otherwise the sources; no GL calls
+void DecodeAssets(const std::string &dir, DecodedAssets &out);
+bool WriteAssetBundle(const std::string &path, const DecodedAssets &in);
+
+// main thread only
+GameAssets UploadAssets(const DecodedAssets &in);
+void UnloadAssets(GameAssets &a);
+
+#endif
@@ -0,0 +1,38 @@
+#include "game_rules.h"
+
+ShotOutcome ClassifyPocketed(const std::vector<int> &ids) {
+    ShotOutcome o;
+    for (int id : ids) {
+        if (id==0) o.foul=true;
+        else if (id==8) o.pocket8=true;
+        else o.scored++;
+    }
+    return o;
+}
+
+void RulesTick(TableSim &sim, TurnState &t, int substeps, float dt) {
+    bool foul=false, scoredBall=false;
+    for (int sub=0; sub<substeps && !t.gameOver; ++sub) {
+        sim.advance(1.0f / substeps);
+
+        ShotOutcome o = ClassifyPocketed(sim.pocketed);
+        t.score[t.currentPlayer] += o.scored;
+        if (o.scored > 0) scoredBall = true;
+        if (o.foul) {
+            foul = true;
+            if (t.score[t.currentPlayer] > 0) t.score[t.currentPlayer]--;
+            t.currentPlayer = (t.currentPlayer==1?2:1);
+            t.waitingPlacement = true;
+            t.shotInProgress = false;
+        }
+        if (o.pocket8) { t.winner = t.currentPlayer; t.gameOver = true; }
+    }
+
+    // early turn end detection
+    if (sim.allVerySlow() && t.shotInProgress) t.slowTimer += dt; else t.slowTimer = 0.0f;
+    if (t.slowTimer >= TURN_SLOW_SECONDS && t.shotInProgress) {
+        if (!foul && !scoredBall) t.currentPlayer = (t.currentPlayer==1?2:1);
+        t.shotInProgress = false;
+        t.slowTimer = 0.0f;
+    }
+}
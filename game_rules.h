@@ -0,0 +1,42 @@
+// 8-ball turn rules as the game applies them, shared with the headless tools.
+
+#ifndef GAME_RULES_H
+#define GAME_RULES_H
+
+#include "table_sim.h"
+#include <vector>
+
+// What a batch of pocketed ids means for the shooter.
+struct ShotOutcome {
+    int scored = 0;        // object balls other than the 8 (+1 each)
+    bool foul = false;     // cue ball pocketed: -1, ball in hand to the opponent
+    bool pocket8 = false;  // game over; the winner is whoever has the turn after the foul check
+};
+
+ShotOutcome ClassifyPocketed(const std::vector<int> &ids);
+
+// balls all below SLOW_THRESHOLD this long end the shot early
+const float TURN_SLOW_SECONDS = 0.35f;
+
+// Turn bookkeeping that changes with the physics (the game's UI state lives elsewhere).
+struct TurnState {
+    int currentPlayer = 1;
+    int score[3] = { 0, 0, 0 };
+    bool waitingPlacement = false;
+    bool shotInProgress = false;
+    bool gameOver = false;
+    int winner = -1;
+    float slowTimer = 0.0f;
+};
+
+// The game's fixed tick: one 60 Hz frame of table time in two advance()
+// calls. The headless tools tick the same way, so their games are the game's.
+const float GAME_TICK_DT = 1.0f / 60.0f;
+const int GAME_SUBSTEPS = 2;
+
+// One fixed physics tick of dt seconds (one 60 Hz frame of table time), split
+// into `substeps` advance() calls with fouls, scores and the 8 applied after
+// each, then the early turn end. The game and replays both go through here.
+void RulesTick(TableSim &sim, TurnState &t, int substeps, float dt);
+
+#endif
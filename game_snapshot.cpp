@@ -0,0 +1,34 @@
+#include "game_snapshot.h"
+#include <algorithm>
+
+bool SaveSnapshot(const TableSim &sim, const TurnState &turn, uint32_t tick, GameSnapshot &out) {
+    if (sim.balls.size() > (size_t)SNAPSHOT_MAX_BALLS) return false;
+    out.ballCount = (uint8_t)sim.balls.size();
+    std::copy(sim.balls.begin(), sim.balls.end(), out.balls);
+    // at most one entry per pair of balls, so it always fits
+    out.warmCount = (uint8_t)sim.solver.warmCount();
+    for (int k=0; k<out.warmCount; k++) {
+        int a, b;
+        sim.solver.warmContact(k, a, b, out.warmLambda[k]);
+        out.warmA[k] = (uint8_t)a; out.warmB[k] = (uint8_t)b;
+    }
+    out.sleeping = sim.sleeping;
+    out.turn = turn;
+    out.tick = tick;
+    return true;
+}
+
+void RestoreSnapshot(const GameSnapshot &s, TableSim &sim, TurnState &turn) {
+    std::copy(s.balls, s.balls + std::min<size_t>(s.ballCount, sim.balls.size()), sim.balls.begin());
+    sim.pocketed.clear();
+    sim.shotPocketed.clear();
+    sim.solver.forget();
+    for (int k=0; k<s.warmCount; k++) sim.solver.addWarm(s.warmA[k], s.warmB[k], s.warmLambda[k]);
+    sim.sleeping = s.sleeping;
+    turn = s.turn;
+}
+
+void NewGame(TableSim &sim, TurnState &turn) {
+    sim.reset();
+    turn = TurnState();
+}
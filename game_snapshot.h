@@ -0,0 +1,67 @@
+// The whole game (balls, contact warm start, turn rules state, physics tick)
+// as one fixed-size, trivially copyable value: saving or restoring is about a
+// kilobyte of copying at most and never allocates. Take-backs, rollback and
+// search all start from here.
+
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include "table_sim.h"
+#include "game_rules.h"
+#include <cstdint>
+#include <type_traits>
+
+const int SNAPSHOT_MAX_BALLS = 16;   // a rack plus the cue ball
+const int SNAPSHOT_PAIRS = SNAPSHOT_MAX_BALLS * (SNAPSHOT_MAX_BALLS - 1) / 2;
+
+struct GameSnapshot {
+    Ball balls[SNAPSHOT_MAX_BALLS];
+    // the contact solver's warm start, as its pair list
+    uint8_t warmA[SNAPSHOT_PAIRS], warmB[SNAPSHOT_PAIRS];
+    float warmLambda[SNAPSHOT_PAIRS];
+    uint8_t warmCount;
+    uint8_t ballCount;
+    bool sleeping;
+    TurnState turn;
+    uint32_t tick;
+};
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "snapshots are copied as plain bytes");
+
+// false when the table holds more balls than a snapshot does (stress tables)
+bool SaveSnapshot(const TableSim &sim, const TurnState &turn, uint32_t tick, GameSnapshot &out);
+// The table must have the snapshot's ball count (the same game); nothing
+// that happened since the save survives, including this shot's pockets.
+void RestoreSnapshot(const GameSnapshot &s, TableSim &sim, TurnState &turn);
+
+// a fresh rack with player 1 to break
+void NewGame(TableSim &sim, TurnState &turn);
+
+// The last N values pushed; older ones fall off the far end.
+template <class T, int N>
+class UndoRing {
+public:
+    void push(const T &v) {
+        ring[head] = v;
+        head = (head + 1) % N;
+        if (count < N) count++;
+    }
+    // the newest value, removing it
+    bool pop(T &out) {
+        if (count == 0) return false;
+        head = (head + N - 1) % N;
+        count--;
+        out = ring[head];
+        return true;
+    }
+    // the value back places behind the newest (0: the newest), without removing it
+    const T &peek(int back) const { return ring[(head + N - 1 - back) % N]; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+
+private:
+    T ring[N];
+    int head = 0, count = 0;
+};
+
+#endif
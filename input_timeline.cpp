@@ -0,0 +1,58 @@
+#include "input_timeline.h"
+#include <algorithm>
+
+void InputTimeline::sample(double ms, Vector2 mouse, bool down) {
+    bool was = used ? latest().down : false;
+    if (down && !was && !pending.pressed) { pending.pressed = true; pending.pressMs = ms; }
+    if (!down && was) { pending.released = true; pending.releaseMs = ms; pending.releaseMouse = mouse; }
+    ring[head] = { ms, mouse, down };
+    head = (head + 1) % INPUT_RING;
+    if (used < INPUT_RING) used++;
+    pending.polls++;
+}
+
+void InputTimeline::key(int k) {
+    if (pending.keyCount < INPUT_MAX_KEYS) pending.keys[pending.keyCount++] = k;
+}
+
+void InputTimeline::beginFrame() {
+    frame = pending;
+    pending = Span();
+}
+
+bool InputTimeline::keyPressed(int k) const {
+    for (int i=0;i<frame.keyCount;i++) if (frame.keys[i] == k) return true;
+    return false;
+}
+
+const InputSample &InputTimeline::latest() const {
+    static const InputSample none = { 0.0, { 0, 0 }, false };
+    return used ? at(0) : none;
+}
+
+void LatencyTrack::add(float ms) {
+    values[head] = ms;
+    head = (head + 1) % LATENCY_RING;
+    if (used < LATENCY_RING) used++;
+}
+
+float LatencyTrack::average() const {
+    float sum = 0.0f;
+    for (int i=0;i<used;i++) sum += values[i];
+    return used ? sum / used : 0.0f;
+}
+
+float LatencyTrack::p99() const {
+    if (!used) return 0.0f;
+    float sorted[LATENCY_RING];
+    std::copy(values, values + used, sorted);
+    int k = std::min(used - 1, (int)(used * 0.99f));
+    std::nth_element(sorted, sorted + k, sorted + used);
+    return sorted[k];
+}
+
+float LatencyTrack::worst() const {
+    float w = 0.0f;
+    for (int i=0;i<used;i++) w = std::max(w, values[i]);
+    return w;
+}
@@ -0,0 +1,96 @@
+// Timestamped mouse input between frames.
+// raylib reads input once per frame, so a 60 Hz loop only knows the cue was
+// released somewhere in the last 16 ms, and aims with wherever the mouse was
+// at the last poll. The game instead feeds every poll (the frame's own and
+// the extra ones it makes between frames while a shot can be taken) into an
+// InputTimeline with its time. A shot then uses the time and mouse position
+// of the poll that saw the release: power from how long the button was held,
+// angle from where the mouse was.
+//
+// No raylib here: the caller polls and passes the state in.
+
+#ifndef INPUT_TIMELINE_H
+#define INPUT_TIMELINE_H
+
+#include "table_sim.h"
+
+const int INPUT_RING = 256;             // samples kept: a quarter second at 1 kHz
+const int INPUT_MAX_KEYS = 16;          // key presses kept per frame
+const double INPUT_SAMPLE_MS = 1.0;     // poll interval between frames while a shot can be taken
+// power gained per millisecond held: the old 0.45 per 60 Hz physics tick
+const float CHARGE_PER_MS = 0.45f * 60.0f / 1000.0f;
+
+struct InputSample {
+    double ms;
+    Vector2 mouse;
+    bool down;              // left button
+};
+
+// the power of a shot charged for heldMs
+inline float ChargePower(double heldMs) {
+    return heldMs <= 0.0 ? 0.0f : fminf(MAX_POWER, (float)heldMs * CHARGE_PER_MS);
+}
+
+class InputTimeline {
+public:
+    // One poll: call after every PollInputEvents(), EndDrawing()'s included.
+    void sample(double ms, Vector2 mouse, bool down);
+    // a key press seen at the latest poll (raylib's GetKeyPressed queue)
+    void key(int k);
+
+    // Frame side. Takes everything since the last beginFrame(); the queries
+    // below answer for that span, like raylib's per-frame ones.
+    void beginFrame();
+    bool pressed() const { return frame.pressed; }
+    bool released() const { return frame.released; }
+    bool down() const { return latest().down; }
+    bool keyPressed(int k) const;
+    Vector2 mouse() const { return latest().mouse; }
+    // when the latest mouse position was read
+    double mouseMs() const { return latest().ms; }
+    // the first press and the last release, at the polls that saw them
+    double pressMs() const { return frame.pressMs; }
+    double releaseMs() const { return frame.releaseMs; }
+    Vector2 releaseMouse() const { return frame.releaseMouse; }
+    // polls that went into this frame
+    int polls() const { return frame.polls; }
+
+    int count() const { return used; }
+    // 0 = the newest sample
+    const InputSample &at(int back) const { return ring[(head - 1 - back + 2*INPUT_RING) % INPUT_RING]; }
+
+private:
+    struct Span {
+        bool pressed = false, released = false;
+        double pressMs = 0.0, releaseMs = 0.0;
+        Vector2 releaseMouse = { 0, 0 };
+        int keys[INPUT_MAX_KEYS];
+        int keyCount = 0;
+        int polls = 0;
+    };
+    InputSample ring[INPUT_RING];
+    int head = 0, used = 0;
+    Span pending, frame;
+
+    const InputSample &latest() const;
+};
+
+// Rolling figures for one latency, in milliseconds, over the last
+// LATENCY_RING measurements.
+const int LATENCY_RING = 128;
+
+class LatencyTrack {
+public:
+    void add(float ms);
+    int count() const { return used; }
+    float last() const { return used ? values[(head + LATENCY_RING - 1) % LATENCY_RING] : 0.0f; }
+    float average() const;
+    float p99() const;
+    float worst() const;
+
+private:
+    float values[LATENCY_RING];
+    int head = 0, used = 0;
+};
+
+#endif
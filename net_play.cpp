@@ -0,0 +1,365 @@
+// Sockets first: on Windows, winsock must come before raylib.h (pulled in
+// by table_sim.h) with the GDI/USER parts that clash with raylib left out.
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "net_play.h"
+#include <algorithm>
+#include <cstring>
+
+// ---------------- sockets ----------------
+
+#ifdef _WIN32
+static bool NetStartup() {
+    static bool ok = [] { WSADATA d; return WSAStartup(MAKEWORD(2, 2), &d) == 0; }();
+    return ok;
+}
+static void CloseSocket(intptr_t fd) { closesocket((SOCKET)fd); }
+static bool SetNonBlocking(intptr_t fd) { u_long on = 1; return ioctlsocket((SOCKET)fd, FIONBIO, &on) == 0; }
+#else
+static bool NetStartup() { return true; }
+static void CloseSocket(intptr_t fd) { close((int)fd); }
+static bool SetNonBlocking(intptr_t fd) { int fl = fcntl((int)fd, F_GETFL, 0); return fl >= 0 && fcntl((int)fd, F_SETFL, fl | O_NONBLOCK) == 0; }
+#endif
+
+NetLink::~NetLink() {
+    if (fd >= 0) CloseSocket(fd);
+}
+
+bool NetLink::open(uint16_t port) {
+    if (!NetStartup()) return false;
+    intptr_t s = (intptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s < 0) return false;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(s, (sockaddr *)&addr, sizeof(addr)) != 0 || !SetNonBlocking(s)) { CloseSocket(s); return false; }
+    fd = s;
+    return true;
+}
+
+bool NetLink::connect(const char *host, uint16_t port) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) return false;
+    peerAddr = ((sockaddr_in *)res->ai_addr)->sin_addr.s_addr;
+    peerPort = htons(port);
+    freeaddrinfo(res);
+    return true;
+}
+
+uint16_t NetLink::localPort() const {
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || getsockname(fd, (sockaddr *)&addr, &len) != 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+void NetLink::impair(double latency, double jitter, double loss, unsigned seed) {
+    impaired = true;
+    latencyMs = latency; jitterMs = jitter; lossPct = loss;
+    rng.seed(seed);
+    held.reserve(256);
+}
+
+void NetLink::sendNow(const uint8_t *data, int n) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = peerAddr;
+    addr.sin_port = peerPort;
+    sendto(fd, (const char *)data, n, 0, (sockaddr *)&addr, sizeof(addr));
+}
+
+void NetLink::send(const uint8_t *data, int n, double nowMs) {
+    if (fd < 0 || !hasPeer() || n > NET_MAX_PACKET) return;
+    bytesSent += n;
+    packetsSent++;
+    if (!impaired) { sendNow(data, n); return; }
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    if (u(rng) * 100.0 < lossPct) { packetsDropped++; return; }
+    held.emplace_back();
+    Held &h = held.back();
+    h.due = nowMs + latencyMs + (u(rng) * 2.0 - 1.0) * jitterMs;
+    h.n = n;
+    memcpy(h.data, data, n);
+}
+
+int NetLink::receive(uint8_t *buf, int cap, double nowMs) {
+    if (fd < 0) return 0;
+    for (size_t i=0; i<held.size(); ) {
+        if (held[i].due > nowMs) { i++; continue; }
+        sendNow(held[i].data, held[i].n);
+        held[i] = held.back();
+        held.pop_back();
+    }
+    for (;;) {
+        sockaddr_in from = {};
+        socklen_t len = sizeof(from);
+        int n = (int)recvfrom(fd, (char *)buf, cap, 0, (sockaddr *)&from, &len);
+        if (n <= 0) return 0;
+        if (!hasPeer()) { peerAddr = from.sin_addr.s_addr; peerPort = from.sin_port; }
+        else if (from.sin_addr.s_addr != peerAddr || from.sin_port != peerPort) continue;   // not our game
+        return n;
+    }
+}
+
+// ---------------- wire format ----------------
+// packet: 'N' 'P' version seat, varint ack (peer inputs received), varint
+// first (sequence number of the first input carried), u8 count, inputs.
+// input: varint tick, u8 kind, u16 a, u16 b (not for a re-spot), u32 hash.
+
+static const uint8_t NET_VERSION = 3;   // same physics as REPLAY_VERSION
+static const int NET_MAX_INPUTS = 32;   // per packet; far more than are ever unacknowledged
+
+struct Writer {
+    uint8_t *p, *end;
+    void u8(uint8_t v) { if (p < end) *p++ = v; }
+    void u16(uint16_t v) { u8((uint8_t)v); u8((uint8_t)(v >> 8)); }
+    void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); }
+    void varint(uint32_t v) { while (v >= 0x80) { u8((uint8_t)(v | 0x80)); v >>= 7; } u8((uint8_t)v); }
+};
+
+struct Reader {
+    const uint8_t *p, *end;
+    bool bad = false;
+    uint8_t u8() { if (p >= end) { bad = true; return 0; } return *p++; }
+    uint16_t u16() { uint16_t lo = u8(); return (uint16_t)(lo | (u8() << 8)); }
+    uint32_t u32() { uint32_t lo = u16(); return lo | ((uint32_t)u16() << 16); }
+    uint32_t varint() {
+        uint32_t v = 0;
+        for (int shift=0; shift<35; shift+=7) {
+            uint8_t b = u8();
+            v |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        bad = true;
+        return 0;
+    }
+};
+
+static void PutInput(Writer &w, const NetInput &in) {
+    w.varint(in.tick);
+    w.u8(in.kind);
+    if (in.kind != REPLAY_SPOT) { w.u16(in.a); w.u16(in.b); }
+    w.u32(in.hash);
+}
+
+int NetSession::inputBytes(const NetInput &in) {
+    uint8_t buf[16];
+    Writer w = { buf, buf + sizeof(buf) };
+    PutInput(w, in);
+    return (int)(w.p - buf);
+}
+
+// ---------------- quantization ----------------
+
+static const float PI_F = 3.14159265f;
+
+static uint16_t QuantizeUnit(float v) { return (uint16_t)lroundf(clampf_custom(v, 0.0f, 1.0f) * 65535.0f); }
+static float DequantizeUnit(uint16_t q) { return q / 65535.0f; }
+
+static uint16_t QuantizeAngle(float angle) {
+    float turns = (angle + PI_F) / (2.0f * PI_F);
+    turns -= floorf(turns);
+    return (uint16_t)((uint32_t)lroundf(turns * 65536.0f) & 0xffff);
+}
+static float DequantizeAngle(uint16_t q) { return q * (2.0f * PI_F / 65536.0f) - PI_F; }
+
+static Vector2 DequantizePlace(const TableLayout &L, uint16_t a, uint16_t b) {
+    return { L.play.x + DequantizeUnit(a) * L.play.width, L.play.y + DequantizeUnit(b) * L.play.height };
+}
+
+// the same state changes the game makes around these calls (see ReplayPlayer)
+static void ApplyInput(TableSim &sim, TurnState &turn, const NetInput &in) {
+    if (in.kind == REPLAY_SHOT) {
+        sim.shoot(DequantizeAngle(in.a), DequantizeUnit(in.b) * MAX_POWER);
+        turn.shotInProgress = true;
+        turn.slowTimer = 0.0f;
+    } else if (in.kind == REPLAY_PLACE) {
+        sim.placeCueBall(DequantizePlace(sim.layout, in.a, in.b));
+        turn.waitingPlacement = false;
+    } else if (in.kind == REPLAY_SPOT) {
+        sim.spotCueBall();
+        turn.waitingPlacement = false;
+    }
+}
+
+static void RecordInput(ReplayRecorder *rec, const TableSim &sim, const TurnState &turn, const NetInput &in) {
+    if (!rec) return;
+    if (in.kind == REPLAY_SHOT) rec->shot(in.tick, sim, turn, DequantizeAngle(in.a), DequantizeUnit(in.b) * MAX_POWER);
+    else if (in.kind == REPLAY_PLACE) rec->place(in.tick, DequantizePlace(sim.layout, in.a, in.b));
+    else if (in.kind == REPLAY_SPOT) rec->spot(in.tick);
+}
+
+// ---------------- session ----------------
+
+NetSession::NetSession(NetLink &link, int localSeat, TableSim &sim, TurnState &turn, int substeps, ReplayRecorder *recorder)
+    : link(link), localSeat(localSeat), sim(sim), turn(turn), substeps(substeps), recorder(recorder), ring(NET_ROLLBACK_TICKS) {
+    // a whole game stays well inside these; play should not allocate
+    inputs.reserve(1024);
+    sent.reserve(512);
+    madeMs.reserve(512);
+    shownMs.reserve(512);
+}
+
+bool NetSession::pending() const {
+    return !inputs.empty() && inputs.back().remoteSeq < 0 && inputs.back().in.tick >= now;
+}
+
+bool NetSession::localTurn() const {
+    return !turn.gameOver && turn.currentPlayer == localSeat && !pending();
+}
+
+void NetSession::begin() {
+    NewGame(sim, turn);
+    now = 0;
+    saveTick();
+    if (recorder) recorder->begin(sim, substeps);
+}
+
+void NetSession::saveTick() {
+    SaveSnapshot(sim, turn, now, ring[now % NET_ROLLBACK_TICKS]);
+}
+
+void NetSession::applyInputs(uint32_t t) {
+    auto first = std::lower_bound(inputs.begin(), inputs.end(), t, [](const Logged &l, uint32_t tk) { return l.in.tick < tk; });
+    if (first == inputs.end() || first->in.tick != t) return;
+    // the peer's view of this tick, checked once, before anything applies
+    uint32_t hash = 0;
+    bool hashed = false;
+    for (auto it = first; it != inputs.end() && it->in.tick == t; ++it) {
+        if (it->remoteSeq < 0 || it->shown) continue;
+        if (!hashed) { hash = ReplayChecksum(sim, turn); hashed = true; }
+        if (hash != it->in.hash) st.divergences++;
+        RecordInput(recorder, sim, turn, it->in);
+        it->shown = true;
+        shownMs[it->remoteSeq] = clockMs;
+    }
+    for (auto it = first; it != inputs.end() && it->in.tick == t; ++it) ApplyInput(sim, turn, it->in);
+}
+
+void NetSession::stepTick() {
+    if (turn.gameOver) return;
+    applyInputs(now);
+    RulesTick(sim, turn, substeps, GAME_TICK_DT);
+    now++;
+    saveTick();
+}
+
+void NetSession::rollback(uint32_t t) {
+    const GameSnapshot &s = ring[t % NET_ROLLBACK_TICKS];
+    if (now - t >= (uint32_t)NET_ROLLBACK_TICKS || s.tick != t) { st.tooLate++; return; }
+    RestoreSnapshot(s, sim, turn);
+    st.rollbacks++;
+    st.resimTicks += now - t;
+    // a late shot can end the game before the present; the game stops ticking there
+    uint32_t k = t;
+    for (; k < now && !turn.gameOver; k++) {
+        applyInputs(k);
+        RulesTick(sim, turn, substeps, GAME_TICK_DT);
+        SaveSnapshot(sim, turn, k + 1, ring[(k + 1) % NET_ROLLBACK_TICKS]);
+    }
+    now = k;
+}
+
+void NetSession::local(uint8_t kind, uint16_t a, uint16_t b) {
+    NetInput in = { now, kind, a, b, ReplayChecksum(sim, turn) };
+    RecordInput(recorder, sim, turn, in);
+    inputs.push_back({ in, -1, false });
+    sent.push_back(in);
+    madeMs.push_back(clockMs);
+    st.inputsSent++;
+    st.inputBytes += inputBytes(in);
+    // out now rather than on the next update()
+    if (link.hasPeer()) sendPacket();
+}
+
+void NetSession::shoot(float angle, float power) {
+    local(REPLAY_SHOT, QuantizeAngle(angle), QuantizeUnit(power / MAX_POWER));
+}
+
+bool NetSession::place(Vector2 p) {
+    const Rectangle &play = sim.layout.play;
+    uint16_t a = QuantizeUnit((p.x - play.x) / play.width), b = QuantizeUnit((p.y - play.y) / play.height);
+    if (!sim.canPlaceCueBall(DequantizePlace(sim.layout, a, b))) return false;
+    local(REPLAY_PLACE, a, b);
+    return true;
+}
+
+void NetSession::spot() {
+    local(REPLAY_SPOT, 0, 0);
+}
+
+void NetSession::received(const NetInput &in) {
+    st.inputsReceived++;
+    auto at = std::upper_bound(inputs.begin(), inputs.end(), in.tick, [](uint32_t tk, const Logged &l) { return tk < l.in.tick; });
+    inputs.insert(at, { in, (int)shownMs.size(), false });
+    shownMs.push_back(-1.0);
+    // already past its tick here: replay from then (this shows it too)
+    if (in.tick < now) rollback(in.tick);
+}
+
+void NetSession::readPacket(const uint8_t *p, int n) {
+    Reader r = { p, p + n };
+    if (r.u8() != 'N' || r.u8() != 'P' || r.u8() != NET_VERSION || r.u8() != (uint8_t)(3 - localSeat)) return;
+    uint32_t ack = r.varint();
+    uint32_t first = r.varint();
+    int count = r.u8();
+    if (r.bad || count > NET_MAX_INPUTS) return;
+    heardPeer = true;
+    peerAcked = std::max(peerAcked, std::min(ack, (uint32_t)sent.size()));
+    for (int i=0; i<count; i++) {
+        NetInput in;
+        in.tick = r.varint();
+        in.kind = r.u8();
+        in.a = in.b = 0;
+        if (in.kind != REPLAY_SPOT) { in.a = r.u16(); in.b = r.u16(); }
+        in.hash = r.u32();
+        if (r.bad || (in.kind != REPLAY_SHOT && in.kind != REPLAY_PLACE && in.kind != REPLAY_SPOT)) return;
+        uint32_t seq = first + (uint32_t)i;
+        if (seq < remoteCount) continue;   // already have it
+        if (seq > remoteCount) return;     // cannot happen: the peer repeats from our ack
+        received(in);
+        remoteCount++;
+        ackDirty = true;
+    }
+}
+
+void NetSession::sendPacket() {
+    uint8_t buf[NET_MAX_PACKET];
+    Writer w = { buf, buf + sizeof(buf) };
+    w.u8('N'); w.u8('P'); w.u8(NET_VERSION); w.u8((uint8_t)localSeat);
+    w.varint(remoteCount);
+    w.varint(peerAcked);
+    int count = std::min((int)sent.size() - (int)peerAcked, NET_MAX_INPUTS);
+    w.u8((uint8_t)count);
+    for (int i=0; i<count; i++) PutInput(w, sent[peerAcked + i]);
+    link.send(buf, (int)(w.p - buf), clockMs);
+    lastSendMs = clockMs;
+    ackDirty = false;
+}
+
+void NetSession::update(double nowMs) {
+    clockMs = nowMs;
+    uint8_t buf[NET_MAX_PACKET];
+    for (int n; (n = link.receive(buf, sizeof(buf), nowMs)) > 0; ) readPacket(buf, n);
+    if (!link.hasPeer()) return;
+    bool unacked = peerAcked < sent.size();
+    if (ackDirty || (unacked && nowMs - lastSendMs >= NET_RESEND_MS) || nowMs - lastSendMs >= NET_KEEPALIVE_MS)
+        sendPacket();
+}
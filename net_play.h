@@ -0,0 +1,159 @@
+// Two-machine play over UDP.
+// Only inputs travel: each shot, ball-in-hand placement or re-spot with the
+// physics tick it applies before and a hash of the table at that tick, about
+// a dozen bytes. Both ends run the same deterministic RulesTick ticks. Play
+// is turn by turn (a side only makes inputs on its own turn), and an input
+// that arrives after its tick has already run here rolls the table back to
+// the snapshot taken at that tick and re-simulates to the present.
+//
+// Inputs are numbered; every packet acknowledges what has arrived and repeats
+// whatever the peer has not acknowledged yet, so a lost packet costs a resend
+// interval, never a stall.
+
+#ifndef NET_PLAY_H
+#define NET_PLAY_H
+
+#include "table_sim.h"
+#include "game_rules.h"
+#include "game_snapshot.h"
+#include "replay.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+const uint16_t NET_DEFAULT_PORT = 38888;
+const int NET_ROLLBACK_TICKS = 600;    // snapshots kept: inputs up to 10 s late
+const double NET_RESEND_MS = 50.0;     // unacknowledged inputs go out again this often
+const double NET_KEEPALIVE_MS = 250.0;
+const int NET_MAX_PACKET = 512;
+
+// A non-blocking UDP socket talking to one peer. impair() delays and drops
+// outgoing datagrams for the loopback tests.
+class NetLink {
+public:
+    NetLink() = default;
+    ~NetLink();
+    NetLink(const NetLink &) = delete;
+    NetLink &operator=(const NetLink &) = delete;
+
+    // binds every interface; port 0 picks a free one
+    bool open(uint16_t port);
+    // Sends to host:port. A side that never connects answers whoever
+    // reaches it first.
+    bool connect(const char *host, uint16_t port);
+    uint16_t localPort() const;
+    bool hasPeer() const { return peerPort != 0; }
+
+    // every datagram is lost with lossPct percent chance, else held for
+    // latencyMs +- jitterMs (so they can also arrive out of order)
+    void impair(double latencyMs, double jitterMs, double lossPct, unsigned seed);
+    void send(const uint8_t *data, int n, double nowMs);
+    // the next datagram from the peer (0 when none), after sending any
+    // held datagrams that are due
+    int receive(uint8_t *buf, int cap, double nowMs);
+
+    long bytesSent = 0, packetsSent = 0, packetsDropped = 0;
+
+private:
+    struct Held { double due; int n; uint8_t data[NET_MAX_PACKET]; };
+    intptr_t fd = -1;
+    uint32_t peerAddr = 0;   // network order
+    uint16_t peerPort = 0;
+    bool impaired = false;
+    double latencyMs = 0.0, jitterMs = 0.0, lossPct = 0.0;
+    std::mt19937 rng;
+    std::vector<Held> held;
+
+    void sendNow(const uint8_t *data, int n);
+};
+
+// kinds as in replays: REPLAY_SHOT, REPLAY_PLACE, REPLAY_SPOT
+struct NetInput {
+    uint32_t tick;        // applied before this physics tick runs
+    uint8_t kind;
+    uint16_t a, b;        // quantized angle and power, or placement across the play area
+    uint32_t hash;        // ReplayChecksum of the table at tick, before its inputs
+};
+
+struct NetStats {
+    long inputsSent = 0, inputsReceived = 0;
+    long inputBytes = 0;                  // ours, as encoded (before packet headers and resends)
+    long rollbacks = 0, resimTicks = 0;   // ticks re-simulated for late inputs
+    long divergences = 0;                 // peer's hash at an input's tick differed from ours
+    long tooLate = 0;                     // older than the snapshot ring: could not be applied
+};
+
+// One networked game. The session owns ticking sim and turn: the caller
+// calls stepTick() where it would call RulesTick() and routes this side's
+// inputs through shoot() / place() / spot().
+class NetSession {
+public:
+    NetSession(NetLink &link, int localSeat, TableSim &sim, TurnState &turn, int substeps, ReplayRecorder *recorder = nullptr);
+
+    int seat() const { return localSeat; }
+    // a packet has arrived from the peer
+    bool connected() const { return heardPeer; }
+    uint32_t tick() const { return now; }
+    // whether it is this side's move and nothing of ours is waiting for the next tick
+    bool localTurn() const;
+    // an input of ours made this tick and not applied yet
+    bool pending() const;
+
+    // A fresh rack at tick 0, recording from here (both sides call it once
+    // connected). Peer inputs that came in earlier wait for their tick.
+    void begin();
+    // Receives (rolling back for late inputs) and sends; call every frame.
+    void update(double nowMs);
+    // One physics tick: due inputs, then RulesTick.
+    void stepTick();
+
+    // This side's inputs, applied before the next tick on both ends. Values
+    // are quantized first so both ends apply exactly the same ones.
+    void shoot(float angle, float power);
+    // false (nothing sent) when the cue ball cannot go there
+    bool place(Vector2 p);
+    void spot();
+
+    const NetStats &stats() const { return st; }
+    // per input sequence number: when ours were made / the peer's were first
+    // on screen here, in update()'s clock (for latency measurements)
+    const std::vector<double> &localMadeMs() const { return madeMs; }
+    const std::vector<double> &remoteShownMs() const { return shownMs; }
+    // encoded size of an input on the wire
+    static int inputBytes(const NetInput &in);
+
+private:
+    NetLink &link;
+    int localSeat;
+    TableSim &sim;
+    TurnState &turn;
+    int substeps;
+    ReplayRecorder *recorder;
+
+    struct Logged {
+        NetInput in;
+        int remoteSeq;                   // -1 for ours
+        bool shown;                      // a peer input applied here at least once
+    };
+
+    uint32_t now = 0;
+    std::vector<Logged> inputs;          // both sides', by tick
+    std::vector<NetInput> sent;          // ours, by sequence number
+    std::vector<GameSnapshot> ring;      // the table before each recent tick's inputs
+    uint32_t remoteCount = 0;            // peer inputs received (contiguous)
+    uint32_t peerAcked = 0;              // ours the peer has
+    bool heardPeer = false, ackDirty = false;
+    double clockMs = 0.0, lastSendMs = -1e9;
+    NetStats st;
+    std::vector<double> madeMs, shownMs;
+
+    void local(uint8_t kind, uint16_t a, uint16_t b);
+    void received(const NetInput &in);
+    void applyInputs(uint32_t t);
+    void rollback(uint32_t t);
+    void saveTick();
+    void sendPacket();
+    void readPacket(const uint8_t *p, int n);
+};
+
+#endif
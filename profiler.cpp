@@ -0,0 +1,112 @@
+#include "profiler.h"
+
+#ifdef BILLIARD_PROFILE
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static const struct { const char *name; int depth; } PHASE_INFO[PROF_PHASES] = {
+    { "input", 0 }, { "physics", 0 }, { "integrate", 1 }, { "toi", 1 }, { "resolve", 1 },
+    { "collide", 1 }, { "cushions", 1 }, { "pockets", 1 }, { "draw_table", 0 }, { "draw_balls", 0 },
+    { "draw_cue", 0 }, { "raycast", 1 }, { "draw_hud", 0 }, { "present", 0 }
+};
+
+// written by attached threads only (the game loop), so no locking
+static int64_t current[PROF_PHASES];
+static ProfileFrame ring[PROFILE_RING];
+static int head = 0, count = 0;
+static long long totalFrames = 0;
+static int64_t lastFrameEnd = 0;
+
+void ProfileAttachThread() {
+    profileThread = true;
+    if (lastFrameEnd == 0) lastFrameEnd = ProfileNow();
+}
+
+void ProfileAdd(ProfilePhase phase, int64_t ns) {
+    current[phase] += ns;
+}
+
+void ProfileEndFrame() {
+    if (!profileThread) return;
+    int64_t now = ProfileNow();
+    ProfileFrame &f = ring[head];
+    f.frameMs = (float)((now - lastFrameEnd) * 1e-6);
+    for (int p=0;p<PROF_PHASES;p++) { f.phaseMs[p] = (float)(current[p] * 1e-6); current[p] = 0; }
+    lastFrameEnd = now;
+    head = (head + 1) % PROFILE_RING;
+    if (count < PROFILE_RING) count++;
+    totalFrames++;
+}
+
+const char *ProfilePhaseName(int phase) { return PHASE_INFO[phase].name; }
+int ProfilePhaseDepth(int phase) { return PHASE_INFO[phase].depth; }
+int ProfileFrameCount() { return count; }
+
+const ProfileFrame &ProfileFrameAt(int back) {
+    return ring[((head - 1 - back) % PROFILE_RING + PROFILE_RING) % PROFILE_RING];
+}
+
+// nearest-rank percentile; reorders v
+static float Percentile(float *v, int n, float q) {
+    if (n <= 0) return 0.0f;
+    int k = std::max(0, (int)std::ceil(q * n) - 1);
+    std::nth_element(v, v + k, v + n);
+    return v[k];
+}
+
+ProfileSummary ProfileSummarize() {
+    ProfileSummary s;
+    s.frames = count;
+    if (count == 0) return s;
+    static float v[PROFILE_RING];   // the overlay summarizes every frame; no allocation
+    for (int p=-1;p<PROF_PHASES;p++) {
+        double sum = 0.0;
+        for (int i=0;i<count;i++) {
+            const ProfileFrame &f = ProfileFrameAt(i);
+            v[i] = p < 0 ? f.frameMs : f.phaseMs[p];
+            sum += v[i];
+        }
+        float avg = (float)(sum / count), p99 = Percentile(v, count, 0.99f);
+        if (p < 0) { s.frameAvgMs = avg; s.frameP99Ms = p99; }
+        else { s.avgMs[p] = avg; s.p99Ms[p] = p99; }
+    }
+    return s;
+}
+
+bool ProfileWriteCsv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "frame,frame_ms");
+    for (int p=0;p<PROF_PHASES;p++) fprintf(f, ",%s", PHASE_INFO[p].name);
+    fprintf(f, "\n");
+    for (int i=count-1;i>=0;i--) {
+        const ProfileFrame &fr = ProfileFrameAt(i);
+        fprintf(f, "%lld,%.4f", totalFrames - 1 - i, fr.frameMs);
+        for (int p=0;p<PROF_PHASES;p++) fprintf(f, ",%.4f", fr.phaseMs[p]);
+        fprintf(f, "\n");
+    }
+    return fclose(f) == 0;
+}
+
+bool ProfileWriteJson(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    ProfileSummary s = ProfileSummarize();
+    fprintf(f, "{\n  \"ring\": %d,\n  \"frames_total\": %lld,\n  \"summary\": {\n", PROFILE_RING, totalFrames);
+    fprintf(f, "    \"frame\": { \"avg_ms\": %.4f, \"p99_ms\": %.4f }", s.frameAvgMs, s.frameP99Ms);
+    for (int p=0;p<PROF_PHASES;p++)
+        fprintf(f, ",\n    \"%s\": { \"avg_ms\": %.4f, \"p99_ms\": %.4f }", PHASE_INFO[p].name, s.avgMs[p], s.p99Ms[p]);
+    fprintf(f, "\n  },\n  \"frames\": [");
+    for (int i=count-1;i>=0;i--) {
+        const ProfileFrame &fr = ProfileFrameAt(i);
+        fprintf(f, "%s\n    { \"frame\": %lld, \"frame_ms\": %.4f", i == count-1 ? "" : ",", totalFrames - 1 - i, fr.frameMs);
+        for (int p=0;p<PROF_PHASES;p++) fprintf(f, ", \"%s\": %.4f", PHASE_INFO[p].name, fr.phaseMs[p]);
+        fprintf(f, " }");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+#endif
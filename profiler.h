@@ -0,0 +1,99 @@
+// Per-phase frame profiler.
+// Build with -DBILLIARD_PROFILE to compile it in. Without it every PROFILE_*
+// macro expands to nothing and profiler.cpp is empty, so the instrumented
+// code is identical to an uninstrumented build.
+//
+// Only threads that called ProfileAttachThread() record: the shot search and
+// odds workers run the same physics and would otherwise land in the game
+// thread's frame. Phase times accumulate per frame and ProfileEndFrame()
+// pushes them into a fixed ring of the last PROFILE_RING frames.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+enum ProfilePhase {
+    PROF_INPUT,
+    PROF_PHYSICS,       // the whole fixed-timestep loop, rules included
+    PROF_INTEGRATE,     // step() moves / event Drift()
+    PROF_TOI,           // event engine: next-impact search (pairs, cushions, pockets)
+    PROF_RESOLVE,       // event engine: applying the impact
+    PROF_COLLIDE,       // step(): ResolveBallCollision pass
+    PROF_CUSHIONS,      // step(): cushion loop
+    PROF_POCKETS,       // step(): pocket detection
+    PROF_DRAW_TABLE,    // table layer rebuild + blit
+    PROF_DRAW_BALLS,
+    PROF_DRAW_CUE,      // cue, trajectory, odds labels
+    PROF_RAYCAST,       // aim trajectory sweeps (inside draw_cue)
+    PROF_DRAW_HUD,      // includes flushing the scene batch
+    PROF_PRESENT,       // cache blit, overlays, EndDrawing (vsync / event wait)
+    PROF_PHASES
+};
+
+const int PROFILE_RING = 600;   // 10 s at 60 FPS
+
+#ifdef BILLIARD_PROFILE
+
+#include <chrono>
+#include <cstdint>
+
+struct ProfileFrame {
+    float frameMs;                  // endFrame to endFrame
+    float phaseMs[PROF_PHASES];
+};
+
+struct ProfileSummary {
+    int frames = 0;
+    float avgMs[PROF_PHASES] = { 0 }, p99Ms[PROF_PHASES] = { 0 };
+    float frameAvgMs = 0.0f, frameP99Ms = 0.0f;
+};
+
+inline thread_local bool profileThread = false;
+
+inline int64_t ProfileNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ProfileAttachThread();
+void ProfileAdd(ProfilePhase phase, int64_t ns);
+void ProfileEndFrame();
+
+const char *ProfilePhaseName(int phase);
+// nesting depth for display: integrate..pockets run inside physics,
+// raycast inside draw_cue
+int ProfilePhaseDepth(int phase);
+int ProfileFrameCount();
+// 0 = the newest finished frame
+const ProfileFrame &ProfileFrameAt(int back);
+ProfileSummary ProfileSummarize();
+
+// one row / object per ring frame, oldest first
+bool ProfileWriteCsv(const char *path);
+bool ProfileWriteJson(const char *path);
+
+struct ProfileScope {
+    ProfilePhase phase;
+    int64_t t0;
+    explicit ProfileScope(ProfilePhase p) : phase(p), t0(profileThread ? ProfileNow() : 0) {}
+    ~ProfileScope() { if (profileThread) ProfileAdd(phase, ProfileNow() - t0); }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT2(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CAT(profileScope, __LINE__)(phase)
+// for spans that are not a block of their own
+#define PROFILE_BEGIN(var) const int64_t var = profileThread ? ProfileNow() : 0
+#define PROFILE_END(var, phase) do { if (profileThread) ProfileAdd(phase, ProfileNow() - (var)); } while (0)
+#define PROFILE_FRAME_END() ProfileEndFrame()
+
+#else
+
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_BEGIN(var) ((void)0)
+#define PROFILE_END(var, phase) ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+
+#endif
+
+#endif
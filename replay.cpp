@@ -0,0 +1,316 @@
+#include "replay.h"
+#include "game_snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// ---------------- byte helpers (little-endian, floats as raw bits) ----------------
+
+static void PutU8(std::vector<uint8_t> &out, uint8_t v) { out.push_back(v); }
+
+static void PutU32(std::vector<uint8_t> &out, uint32_t v) {
+    for (int i=0;i<4;i++) out.push_back((uint8_t)(v >> (8*i)));
+}
+
+static void PutF32(std::vector<uint8_t> &out, float f) {
+    uint32_t v; memcpy(&v, &f, 4);
+    PutU32(out, v);
+}
+
+static void PutVarint(std::vector<uint8_t> &out, uint32_t v) {
+    while (v >= 0x80) { out.push_back((uint8_t)(v | 0x80)); v >>= 7; }
+    out.push_back((uint8_t)v);
+}
+
+struct Reader {
+    const std::vector<uint8_t> &in;
+    size_t at = 0;
+    bool bad = false;
+
+    explicit Reader(const std::vector<uint8_t> &in) : in(in) {}
+    uint8_t u8() { if (at >= in.size()) { bad = true; return 0; } return in[at++]; }
+    uint32_t u32() { uint32_t v = 0; for (int i=0;i<4;i++) v |= (uint32_t)u8() << (8*i); return v; }
+    float f32() { uint32_t v = u32(); float f; memcpy(&f, &v, 4); return f; }
+    uint32_t varint() {
+        uint32_t v = 0;
+        for (int shift=0; shift<35; shift+=7) {
+            uint8_t b = u8();
+            v |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        bad = true;
+        return 0;
+    }
+};
+
+static void PutFingerprint(std::vector<uint8_t> &out, const TableLayout &L) {
+    PutF32(out, L.play.x); PutF32(out, L.play.y); PutF32(out, L.play.width); PutF32(out, L.play.height);
+    PutF32(out, L.ballR);
+}
+
+static void PutSnapshot(std::vector<uint8_t> &out, const std::vector<Ball> &balls, const TurnState &t) {
+    for (auto &b : balls) {
+        PutU8(out, b.active ? 1 : 0);
+        if (!b.active) continue;
+        PutF32(out, b.pos.x); PutF32(out, b.pos.y); PutF32(out, b.vel.x); PutF32(out, b.vel.y);
+    }
+    PutU8(out, (uint8_t)t.currentPlayer);
+    PutVarint(out, (uint32_t)t.score[1]);
+    PutVarint(out, (uint32_t)t.score[2]);
+    PutU8(out, (uint8_t)((t.waitingPlacement ? 1 : 0) | (t.shotInProgress ? 2 : 0) | (t.gameOver ? 4 : 0)));
+    PutU8(out, (uint8_t)(int8_t)t.winner);
+    PutF32(out, t.slowTimer);
+}
+
+// false when the turn state read is impossible (a damaged stream)
+static bool ReadSnapshot(Reader &r, std::vector<Ball> &balls, TurnState &t) {
+    for (auto &b : balls) {
+        b.active = r.u8() != 0;
+        b.restSteps = 0;
+        if (!b.active) { b.vel = { 0, 0 }; continue; }
+        b.pos.x = r.f32(); b.pos.y = r.f32(); b.vel.x = r.f32(); b.vel.y = r.f32();
+        if (!std::isfinite(b.pos.x) || !std::isfinite(b.pos.y) || !std::isfinite(b.vel.x) || !std::isfinite(b.vel.y)) return false;
+    }
+    t.currentPlayer = r.u8();
+    t.score[1] = (int)r.varint();
+    t.score[2] = (int)r.varint();
+    uint8_t flags = r.u8();
+    t.waitingPlacement = flags & 1; t.shotInProgress = flags & 2; t.gameOver = flags & 4;
+    t.winner = (int8_t)r.u8();
+    t.slowTimer = r.f32();
+    return (t.currentPlayer == 1 || t.currentPlayer == 2) && t.winner >= -1 && t.winner <= 2;
+}
+
+uint32_t ReplayChecksum(const TableSim &sim, const TurnState &turn) {
+    uint32_t h = 2166136261u;
+    auto mix = [&h](uint32_t v) { for (int i=0;i<4;i++) { h ^= (v >> (8*i)) & 0xff; h *= 16777619u; } };
+    for (auto &b : sim.balls) {
+        mix(b.active ? 1u : 0u);
+        if (!b.active) continue;
+        uint32_t x, y; memcpy(&x, &b.pos.x, 4); memcpy(&y, &b.pos.y, 4);
+        mix(x); mix(y);
+    }
+    mix((uint32_t)turn.score[1]); mix((uint32_t)turn.score[2]);
+    mix((uint32_t)turn.currentPlayer); mix((uint32_t)turn.winner);
+    return h;
+}
+
+// ---------------- recorder ----------------
+
+void ReplayRecorder::begin(const TableSim &sim, int substeps, int keyframeEvery) {
+    bytes.clear();
+    // a whole game is usually under a kilobyte; recording a shot should not allocate
+    bytes.reserve(16384);
+    lastTick = 0;
+    shotCount = 0;
+    this->keyframeEvery = keyframeEvery;
+    open = true;
+    for (char c : { '8', 'B', 'R', 'P' }) PutU8(bytes, (uint8_t)c);
+    PutU8(bytes, REPLAY_VERSION);
+    PutU8(bytes, (uint8_t)substeps);
+    PutFingerprint(bytes, sim.layout);
+    PutU8(bytes, (uint8_t)sim.balls.size());
+    for (auto &b : sim.balls) {
+        PutU8(bytes, (uint8_t)(b.id | (b.active ? 0x80 : 0)));
+        PutF32(bytes, b.pos.x); PutF32(bytes, b.pos.y);
+    }
+}
+
+void ReplayRecorder::event(uint32_t tick, uint8_t kind) {
+    PutVarint(bytes, std::min(tick - lastTick, REPLAY_MAX_GAP));
+    PutU8(bytes, kind);
+    lastTick = tick;
+}
+
+void ReplayRecorder::shot(uint32_t tick, const TableSim &sim, const TurnState &turn, float angle, float power) {
+    if (!open) return;
+    if (keyframeEvery > 0 && shotCount > 0 && shotCount % keyframeEvery == 0) {
+        event(tick, REPLAY_KEYFRAME);
+        PutSnapshot(bytes, sim.balls, turn);
+    }
+    event(tick, REPLAY_SHOT);
+    PutF32(bytes, angle); PutF32(bytes, power);
+    shotCount++;
+}
+
+void ReplayRecorder::place(uint32_t tick, Vector2 p) {
+    if (!open) return;
+    event(tick, REPLAY_PLACE);
+    PutF32(bytes, p.x); PutF32(bytes, p.y);
+}
+
+void ReplayRecorder::spot(uint32_t tick) {
+    if (!open) return;
+    event(tick, REPLAY_SPOT);
+}
+
+const std::vector<uint8_t> &ReplayRecorder::finish(uint32_t tick, const TableSim &sim, const TurnState &turn) {
+    if (open) {
+        event(tick, REPLAY_END);
+        PutU32(bytes, ReplayChecksum(sim, turn));
+        open = false;
+    }
+    return bytes;
+}
+
+void ReplayRecorder::rewind(const ReplayMark &m) {
+    if (m.bytes == 0 || m.bytes > bytes.size()) return;
+    bytes.resize(m.bytes);
+    lastTick = m.lastTick;
+    shotCount = m.shots;
+    open = true;
+}
+
+// ---------------- player ----------------
+
+ReplayPlayer::ReplayPlayer(const TableLayout &layout) : sim(layout) {}
+
+bool ReplayPlayer::load(const std::vector<uint8_t> &data, std::string *error) {
+    auto fail = [error](const char *why) { if (error) *error = why; return false; };
+    Reader r(data);
+    if (r.u8() != '8' || r.u8() != 'B' || r.u8() != 'R' || r.u8() != 'P') return fail("not a replay");
+    if (r.u8() != REPLAY_VERSION) return fail("unsupported replay version");
+    substeps = r.u8();
+    if (substeps < 1) return fail("bad substep count");
+    std::vector<uint8_t> expect;
+    PutFingerprint(expect, sim.layout);
+    for (uint8_t byte : expect) if (r.u8() != byte) return fail("recorded on a different table layout");
+
+    ReplayKeyframe rack;
+    rack.tick = 0;
+    rack.nextEvent = 0;
+    const int count = r.u8();
+    if (count == 0 || count > SNAPSHOT_MAX_BALLS) return fail("bad ball count");
+    rack.balls.resize(count);
+    bool seen[SNAPSHOT_MAX_BALLS] = { false };
+    for (auto &b : rack.balls) {
+        uint8_t idActive = r.u8();
+        b.id = idActive & 0x7f;
+        b.active = (idActive & 0x80) != 0;
+        b.pos.x = r.f32(); b.pos.y = r.f32();
+        b.vel = { 0, 0 };
+        b.restSteps = 0;
+        if (b.id >= count || seen[b.id]) return fail("bad ball ids");
+        if (!std::isfinite(b.pos.x) || !std::isfinite(b.pos.y)) return fail("corrupt rack");
+        seen[b.id] = true;
+    }
+    // shots go to balls[0]
+    if (rack.balls[0].id != 0) return fail("bad ball ids");
+    keyframes.assign(1, rack);
+    events.clear();
+
+    uint32_t t = 0;
+    while (true) {
+        uint32_t delta = r.varint();
+        uint8_t kind = r.u8();
+        if (r.bad) return fail("truncated replay");
+        if (delta > REPLAY_MAX_GAP || t > UINT32_MAX - delta) return fail("corrupt event tick");
+        t += delta;
+        if (kind == REPLAY_END) { end = t; endChecksum = r.u32(); break; }
+        if (kind == REPLAY_KEYFRAME) {
+            ReplayKeyframe k;
+            k.tick = t;
+            k.nextEvent = events.size();
+            k.balls = rack.balls;
+            if (!ReadSnapshot(r, k.balls, k.turn)) return fail(r.bad ? "truncated replay" : "corrupt keyframe");
+            if (k.tick > keyframes.back().tick) keyframes.push_back(k);
+            continue;
+        }
+        ReplayEvent e = { t, kind, 0.0f, 0.0f };
+        if (kind == REPLAY_SHOT || kind == REPLAY_PLACE) {
+            e.a = r.f32(); e.b = r.f32();
+            if (!std::isfinite(e.a) || !std::isfinite(e.b)) return fail("corrupt event");
+            if (kind == REPLAY_SHOT && (e.b < 0.0f || e.b > MAX_POWER)) return fail("corrupt event");
+        }
+        else if (kind != REPLAY_SPOT) return fail("unknown replay event");
+        events.push_back(e);
+    }
+    if (r.bad) return fail("truncated replay");
+
+    tick = 1;   // force seek() to restore the rack
+    seek(0);
+    return true;
+}
+
+size_t ReplayPlayer::shots() const {
+    size_t n = 0;
+    for (auto &e : events) if (e.kind == REPLAY_SHOT) n++;
+    return n;
+}
+
+void ReplayPlayer::applyEvents() {
+    for (; nextEvent < events.size() && events[nextEvent].tick == tick; nextEvent++) {
+        const ReplayEvent &e = events[nextEvent];
+        // the same state changes the game makes around these calls
+        if (e.kind == REPLAY_SHOT) {
+            sim.shoot(e.a, e.b);
+            turn.shotInProgress = true;
+            turn.slowTimer = 0.0f;
+        } else if (e.kind == REPLAY_PLACE) {
+            sim.placeCueBall({ e.a, e.b });
+            turn.waitingPlacement = false;
+        } else if (e.kind == REPLAY_SPOT) {
+            sim.spotCueBall();
+            turn.waitingPlacement = false;
+        }
+    }
+}
+
+void ReplayPlayer::cacheKeyframe() {
+    auto at = std::lower_bound(keyframes.begin(), keyframes.end(), tick,
+                               [](const ReplayKeyframe &k, uint32_t t) { return k.tick < t; });
+    if (at != keyframes.end() && at->tick == tick) return;
+    keyframes.insert(at, ReplayKeyframe{ tick, nextEvent, sim.balls, turn });
+}
+
+void ReplayPlayer::stepTick() {
+    if (tick >= end) return;
+    if (tick % CACHE_TICKS == 0) cacheKeyframe();
+    applyEvents();
+    RulesTick(sim, turn, substeps, GAME_TICK_DT);
+    tick++;
+}
+
+void ReplayPlayer::seek(uint32_t target) {
+    target = std::min(target, end);
+    auto at = std::upper_bound(keyframes.begin(), keyframes.end(), target,
+                               [](uint32_t t, const ReplayKeyframe &k) { return t < k.tick; });
+    const ReplayKeyframe &k = *(at - 1);   // keyframes[0] has tick 0
+    if (tick > target || k.tick > tick) {
+        sim.balls = k.balls;
+        sim.pocketed.clear();
+        sim.shotPocketed.clear();
+        sim.sleeping = false;
+        turn = k.turn;
+        tick = k.tick;
+        nextEvent = k.nextEvent;
+    }
+    while (tick < target) stepTick();
+    if (tick == end) applyEvents();   // anything recorded after the last tick
+}
+
+bool ReplayPlayer::matchesRecording() const {
+    return tick == end && ReplayChecksum(sim, turn) == endChecksum;
+}
+
+// ---------------- files ----------------
+
+bool SaveReplay(const char *path, const std::vector<uint8_t> &data) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+bool LoadReplay(const char *path, std::vector<uint8_t> &data) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    data.clear();
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
@@ -0,0 +1,125 @@
+// Compact deterministic replays.
+// A replay holds the rack plus every shot and ball-in-hand placement, keyed by
+// physics tick. Playback re-simulates the ticks through RulesTick exactly as
+// the game ran them, so no positions need storing; keyframes (optional in the
+// file, cached by the player as it goes) only make seeking cheaper.
+//
+// Stream: "8BRP", version, substeps, table fingerprint, rack, then events
+// of varint tick delta + kind byte + payload, closed by an END checksum.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "table_sim.h"
+#include "game_rules.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint8_t REPLAY_VERSION = 3;   // 2: cushions with jaws and side rails, 3: contact solver
+
+enum ReplayEventKind : uint8_t {
+    REPLAY_SHOT = 1,       // angle, power
+    REPLAY_PLACE = 2,      // placeCueBall(x, y)
+    REPLAY_SPOT = 3,       // spotCueBall()
+    REPLAY_KEYFRAME = 4,   // full table + turn snapshot
+    REPLAY_END = 5         // checksum of the final table + turn
+};
+
+// Longest gap a replay stores between events (an hour of ticks). The table
+// is long at rest by then, so the recorder leaves out any idle time beyond
+// it, and the player rejects a bigger delta as damage rather than simulating
+// it.
+const uint32_t REPLAY_MAX_GAP = 60 * 60 * 60;
+
+struct ReplayEvent {
+    uint32_t tick;         // applied before this physics tick runs
+    uint8_t kind;
+    float a, b;
+};
+
+struct ReplayKeyframe {
+    uint32_t tick;
+    size_t nextEvent;      // first event not yet applied at this tick
+    std::vector<Ball> balls;
+    TurnState turn;
+};
+
+// FNV-1a over ball positions, scores, turn and winner
+uint32_t ReplayChecksum(const TableSim &sim, const TurnState &turn);
+
+// where a recording stands, for taking back what was recorded after it
+struct ReplayMark {
+    size_t bytes = 0;
+    uint32_t lastTick = 0;
+    int shots = 0;
+};
+
+class ReplayRecorder {
+public:
+    // keyframeEvery > 0 stores a snapshot before every Nth shot (bigger files,
+    // faster cold seeks); 0 keeps replays to a few hundred bytes
+    void begin(const TableSim &sim, int substeps, int keyframeEvery = 0);
+    void shot(uint32_t tick, const TableSim &sim, const TurnState &turn, float angle, float power);
+    void place(uint32_t tick, Vector2 p);
+    void spot(uint32_t tick);
+    // Closes the stream; the recorder is idle until the next begin().
+    const std::vector<uint8_t> &finish(uint32_t tick, const TableSim &sim, const TurnState &turn);
+
+    ReplayMark mark() const { return { bytes.size(), lastTick, shotCount }; }
+    // Drops everything recorded since m was taken in this recording (an
+    // undone shot), reopening it if it was finished.
+    void rewind(const ReplayMark &m);
+
+    bool recording() const { return open; }
+    int shots() const { return shotCount; }
+
+private:
+    std::vector<uint8_t> bytes;
+    uint32_t lastTick = 0;
+    int keyframeEvery = 0;
+    int shotCount = 0;
+    bool open = false;
+
+    void event(uint32_t tick, uint8_t kind);
+};
+
+class ReplayPlayer {
+public:
+    TableSim sim;
+    TurnState turn;
+    uint32_t tick = 0;
+
+    explicit ReplayPlayer(const TableLayout &layout);
+    // false (with a reason) on a damaged stream or one recorded on another table
+    bool load(const std::vector<uint8_t> &data, std::string *error = nullptr);
+
+    uint32_t endTick() const { return end; }
+    size_t shots() const;
+    // Restores the nearest keyframe at or before target (unless playing on from
+    // here is shorter) and re-simulates the remaining ticks headlessly.
+    void seek(uint32_t target);
+    void fastForward(uint32_t ticks) { seek(tick + ticks); }
+    // one tick as the game ran it
+    void stepTick();
+    // at endTick: table and score are what the recorder saw
+    bool matchesRecording() const;
+
+    // the player caches a keyframe this often while playing forward
+    static const uint32_t CACHE_TICKS = 1200;
+
+private:
+    int substeps = 2;
+    std::vector<ReplayEvent> events;
+    std::vector<ReplayKeyframe> keyframes;   // by tick; keyframes[0] is the rack
+    size_t nextEvent = 0;
+    uint32_t end = 0, endChecksum = 0;
+
+    void applyEvents();
+    void cacheKeyframe();
+};
+
+bool SaveReplay(const char *path, const std::vector<uint8_t> &data);
+bool LoadReplay(const char *path, std::vector<uint8_t> &data);
+
+#endif
@@ -0,0 +1,186 @@
+#include "shot_ai.h"
+#include <chrono>
+#include <numeric>
+#include <optional>
+
+float ScoreOutcome(const ShotOutcome &o) {
+    // the 8 ends the game: won if the shooter kept the turn, lost after a scratch
+    if (o.pocket8) return o.foul ? -100.0f : 100.0f;
+    // a scratch costs a point and hands over ball in hand
+    if (o.foul) return (float)o.scored - 1.0f - 2.0f;
+    // potting keeps the turn, which is worth something on its own
+    return (float)o.scored + (o.scored > 0 ? 1.5f : 0.0f);
+}
+
+// stride coprime with n, near n/phi, for a scattered full-period visit order
+static long ScatterStride(long n) {
+    long s = (long)(n * 0.6180339887) | 1;
+    while (s > 1 && std::gcd(s, n) != 1) s++;
+    return s < 1 ? 1 : s;
+}
+
+namespace {
+// one search, shared by its tasks (each captures a pointer to it)
+struct Search {
+    typedef std::chrono::steady_clock Clock;
+    const TableSim &table;
+    ThreadPool &pool;
+    const AiConfig &cfg;
+    std::vector<TableSim> *scratch;
+    Clock::time_point deadline;
+    bool budgeted;
+    long total, stride;
+    int chunk;
+    ShotCache *cache;
+    uint64_t state;
+
+    std::mutex bestMutex;
+    AiShot best;
+    long bestIndex;
+
+    void run(long start);
+};
+}
+
+void Search::run(long start) {
+    std::optional<TableSim> copy;
+    int w = pool.worker();
+    if (!scratch) copy.emplace(table);
+    TableSim &sim = scratch ? (*scratch)[w >= 0 ? w : pool.size()] : *copy;
+    AiShot local;
+    long localIndex = total;
+    long n = 0, hits = 0;
+    for (long k = start; k < start + chunk && k < total; k++) {
+        if (budgeted && Clock::now() > deadline) break;
+        long idx = (k * stride) % total;
+        float angle = -3.14159265f + 6.28318531f * (float)(idx / cfg.powerSteps) / cfg.angleSteps;
+        float power = cfg.powerSteps > 1
+            ? cfg.minPower + (MAX_POWER - cfg.minPower) * (float)(idx % cfg.powerSteps) / (cfg.powerSteps - 1)
+            : MAX_POWER;
+        uint64_t key = cache ? ShotKey(state, angle, power) : 0;
+        CachedShot shot;
+        if (cache && cache->find(key, shot)) {
+            hits++;
+        } else {
+            sim.balls = table.balls;
+            sim.shoot(angle, power);
+            sim.advanceUntilRest();
+            shot.outcome = ClassifyPocketed(sim.shotPocketed);
+            if (cache) { shot.after = BallsHash(sim.balls); cache->store(key, shot); }
+        }
+        float score = ScoreOutcome(shot.outcome);
+        n++;
+        if (score > local.score) { local.angle = angle; local.power = power; local.score = score; localIndex = k; }
+    }
+    std::lock_guard<std::mutex> lock(bestMutex);
+    best.evaluated += n;
+    best.cached += hits;
+    if (local.score > best.score || (local.score == best.score && localIndex < bestIndex)) {
+        long evaluated = best.evaluated, cached = best.cached;
+        best = local;
+        best.evaluated = evaluated;
+        best.cached = cached;
+        bestIndex = localIndex;
+    }
+}
+
+AiShot FindBestShot(const TableSim &table, ThreadPool &pool, const AiConfig &cfg, std::vector<TableSim> *scratch) {
+    const long total = (long)cfg.angleSteps * cfg.powerSteps;
+    Search s = { table, pool, cfg, scratch,
+                 Search::Clock::now() + std::chrono::microseconds((long)(cfg.budgetMs * 1000.0)), cfg.budgetMs > 0.0,
+                 total, ScatterStride(total), cfg.chunk > 0 ? cfg.chunk : 32,
+                 cfg.cache, cfg.cache ? BallsHash(table.balls) : 0, {}, AiShot(), total };
+    Search *sp = &s;
+    for (long start = 0; start < total; start += s.chunk) pool.submit([sp, start] { sp->run(start); });
+    pool.wait();
+    return s.best;
+}
+
+Vector2 ChooseCuePlacement(const TableSim &table) {
+    const Rectangle &play = table.layout.play;
+    Vector2 spot = { play.x + play.width*0.18f, play.y + play.height*0.5f };
+    const float r = table.layout.ballR;
+    // rings around the head spot, then give up and return it anyway
+    for (int ring = 0; ring < 12; ring++) {
+        int n = ring == 0 ? 1 : ring * 8;
+        for (int k = 0; k < n; k++) {
+            float a = 6.28318531f * k / n;
+            Vector2 p = { spot.x + cosf(a) * ring * 2.5f * r, spot.y + sinf(a) * ring * 2.5f * r };
+            if (p.x < play.x + r || p.x > play.x + play.width - r || p.y < play.y + r || p.y > play.y + play.height - r) continue;
+            bool ok = true;
+            for (size_t i=1;i<table.balls.size();++i) if (table.balls[i].active && Dist(p, table.balls[i].pos) < 2.0f*r + 1.0f) ok = false;
+            if (ok) return p;
+        }
+    }
+    return spot;
+}
+
+ShotSearchWorker::ShotSearchWorker(const TableLayout &layout, ThreadPool &pool, const AiConfig &cfg)
+    : layout(layout), pool(pool), cfg(cfg) {
+    jobBalls.reserve(16);
+    // built in place: a copied TableSim would not keep the capacity it reserves
+    scratch.reserve(pool.size() + 1);
+    for (int i=0; i<=pool.size(); i++) scratch.emplace_back(layout);
+    worker = std::thread([this] { workerLoop(); });
+}
+
+ShotSearchWorker::~ShotSearchWorker() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+void ShotSearchWorker::start(const TableSim &sim) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        jobBalls = sim.balls;
+        jobHash = BallsHash(sim.balls);
+        hasJob = true;
+        answered = false;
+        generation++;
+    }
+    cv.notify_one();
+}
+
+bool ShotSearchWorker::pending() const {
+    std::lock_guard<std::mutex> lock(m);
+    return hasJob;
+}
+
+bool ShotSearchWorker::take(const TableSim &sim, AiShot &out) {
+    std::lock_guard<std::mutex> lock(m);
+    if (!hasJob || !answered) return false;
+    hasJob = answered = false;
+    if (BallsHash(sim.balls) != jobHash) return false;
+    out = answer;
+    return true;
+}
+
+void ShotSearchWorker::cancel() {
+    std::lock_guard<std::mutex> lock(m);
+    hasJob = answered = false;
+    generation++;
+}
+
+void ShotSearchWorker::workerLoop() {
+    TableSim table(layout);
+    while (true) {
+        unsigned gen;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this] { return stopping || (hasJob && picked != generation); });
+            if (stopping) return;
+            gen = picked = generation;
+            table.balls = jobBalls;
+        }
+        AiShot best = FindBestShot(table, pool, cfg, &scratch);
+
+        std::lock_guard<std::mutex> lock(m);
+        if (gen != generation) continue;   // restarted or cancelled meanwhile
+        answer = best;
+        answered = true;
+    }
+}
@@ -0,0 +1,90 @@
+// Computer player: brute-force angle x power search over copies of the table,
+// spread over a ThreadPool and cut off by a time budget.
+
+#ifndef SHOT_AI_H
+#define SHOT_AI_H
+
+#include "table_sim.h"
+#include "game_rules.h"
+#include "thread_pool.h"
+#include "table_hash.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct AiConfig {
+    int angleSteps = 720;
+    int powerSteps = 6;
+    float minPower = 4.0f;     // powers run evenly from here to MAX_POWER
+    double budgetMs = 120.0;   // answer within this; <= 0 searches the whole grid
+    int chunk = 32;            // candidates per pool task
+    // Outcomes already simulated from the same balls are looked up here
+    // instead (nullptr: always simulate). Shared across searches and threads.
+    ShotCache *cache = nullptr;
+};
+
+struct AiShot {
+    float angle = 0.0f;
+    float power = 0.0f;
+    float score = -1e9f;
+    long evaluated = 0;        // candidates scored before the budget ran out
+    long cached = 0;           // of those, found in the cache instead of simulated
+};
+
+// Value of one simulated shot for the shooter under the game's rules.
+float ScoreOutcome(const ShotOutcome &o);
+
+// Candidates are visited in a scattered order, so a search cut short by the
+// budget still covers every direction coarsely. Ties go to the earlier
+// candidate, which keeps the answer independent of thread timing.
+// scratch: pool.size() + 1 tables on the same layout, one per pool worker and
+// one for the calling thread, that the search shoots on instead of copying
+// the table for every task (nullptr: copy).
+AiShot FindBestShot(const TableSim &table, ThreadPool &pool, const AiConfig &cfg, std::vector<TableSim> *scratch = nullptr);
+
+// Ball in hand: the head spot when free, else the first free spot nearby.
+Vector2 ChooseCuePlacement(const TableSim &table);
+
+// The game's computer turn: FindBestShot on one long-lived thread, so starting
+// a search costs the caller a copy of the balls into storage reserved up
+// front rather than a new thread, a future and a table copy. The search
+// itself shoots on scratch tables made here, so it never allocates either.
+class ShotSearchWorker {
+public:
+    ShotSearchWorker(const TableLayout &layout, ThreadPool &pool, const AiConfig &cfg);
+    ~ShotSearchWorker();
+    ShotSearchWorker(const ShotSearchWorker &) = delete;
+    ShotSearchWorker &operator=(const ShotSearchWorker &) = delete;
+
+    // searches this table, dropping any search still running
+    void start(const TableSim &sim);
+    // started and its answer not taken yet
+    bool pending() const;
+    // The answer to the last start(), once it is in. An answer searched on a
+    // table other than sim's is thrown away (false; start again).
+    bool take(const TableSim &sim, AiShot &out);
+    // forget the current search; its answer is thrown away
+    void cancel();
+
+private:
+    const TableLayout layout;
+    ThreadPool &pool;
+    const AiConfig cfg;
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    bool stopping = false;
+    bool hasJob = false, answered = false;
+    unsigned generation = 0;     // bumped on every start or cancel
+    unsigned picked = 0;         // last generation the worker took up
+    std::vector<Ball> jobBalls;
+    uint64_t jobHash = 0;        // BallsHash(jobBalls)
+    std::vector<TableSim> scratch;   // FindBestShot's, worker thread only
+    AiShot answer;
+    std::thread worker;
+
+    void workerLoop();
+};
+
+#endif
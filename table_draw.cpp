@@ -0,0 +1,44 @@
+#include "table_draw.h"
+
+void DrawTableBackground(const TableLayout &layout, const TableView &view) {
+    const Rectangle &T = layout.table;
+    const Rectangle &P = layout.play;
+    const float s = view.scale;
+    const float rail = TABLE_RAIL_W;
+    auto rect = [&](float x, float y, float w, float h) -> Rectangle {
+        Vector2 o = view.map({ x, y });
+        return { o.x, o.y, w*s, h*s };
+    };
+
+    // rails (wood)
+    const Color wood = {80,40,10,255};
+    DrawRectangleRec(rect(T.x - rail, T.y - rail, T.width + 2.0f*rail, rail), wood);
+    DrawRectangleRec(rect(T.x - rail, T.y + T.height, T.width + 2.0f*rail, rail), wood);
+    DrawRectangleRec(rect(T.x - rail, T.y - rail, rail, T.height + 2.0f*rail), wood);
+    DrawRectangleRec(rect(T.x + T.width, T.y - rail, rail, T.height + 2.0f*rail), wood);
+
+    // play cloth and subtle texture stripes
+    DrawRectangleRec(rect(P.x, P.y, P.width, P.height), (Color){10,120,60,255});
+    for (float y = P.y; y < P.y + P.height; y += 6.0f) {
+        DrawLineV(view.map({ P.x, y }), view.map({ P.x + P.width, y }), (Color){0,60,30,18});
+    }
+
+    // pockets (funnel mouth) - black circles then a darker inner fade
+    for (int i=0;i<layout.config.pockets;i++) {
+        const Vector2 &h = layout.holes[i];
+        DrawCircleV(view.map(h), layout.holeR*s, BLACK);
+        DrawCircleV(view.map(h), layout.holeR*0.7f*s, (Color){0,0,0,200});
+    }
+
+    // cushions (no green pocket lines)
+    for (auto &c : layout.cushions) DrawLineEx(view.map(c.a), view.map(c.b), 6.0f*layout.scale*s, (Color){18,80,20,200});
+}
+
+Color BallColor(int id) {
+    if (id==0) return WHITE;
+    if (id==8) return BLACK;
+    static const Color cs[] = { RED, ORANGE, GOLD, BLUE, PURPLE, DARKGREEN, MAROON };
+    if (id>=1 && id<=7) return cs[id-1];
+    if (id>=9 && id<=15) return cs[(id-9)%7];
+    return WHITE;
+}
@@ -0,0 +1,28 @@
+// Table drawing shared by the game and the spectator wall (raylib).
+// Everything is in table-layout coordinates mapped through a TableView, so
+// the game draws at 1:1 and the wall draws the same table into a small tile.
+
+#ifndef TABLE_DRAW_H
+#define TABLE_DRAW_H
+
+#include "raylib.h"
+#include "table_sim.h"
+
+const float TABLE_RAIL_W = 35.0f;       // wood outside the table rectangle, layout units
+
+// screen = offset + layout * scale
+struct TableView {
+    Vector2 offset = { 0, 0 };
+    float scale = 1.0f;
+
+    Vector2 map(Vector2 p) const { return { offset.x + p.x*scale, offset.y + p.y*scale }; }
+};
+
+// Rails, cloth, pockets and cushions: the static part of a table, meant to
+// be baked into a render texture once rather than drawn every frame.
+void DrawTableBackground(const TableLayout &layout, const TableView &view);
+
+// the flat colour of ball id when there is no sprite for it
+Color BallColor(int id);
+
+#endif
@@ -0,0 +1,108 @@
+#include "table_env.h"
+#include "table_sim.h"
+#include "game_rules.h"
+#include "game_snapshot.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+static const int ENV_MAX_TICKS = 20000;      // a shot that somehow never settles
+static const int ENV_CHUNK = 32;             // tables per pool task
+
+struct EnvBatch {
+    std::vector<TableSim> sims;
+    std::vector<TurnState> turns;
+    ThreadPool pool;
+
+    EnvBatch(int tables, int threads) : sims(tables, TableSim(MakeTableLayout(1000, 650))), turns(tables), pool(threads) {}
+
+    // fn(first, last) over the batch in pool-sized chunks
+    template <class F>
+    void forChunks(F fn) {
+        const int n = (int)sims.size();
+        for (int first=0; first<n; first+=ENV_CHUNK) {
+            int last = std::min(n, first + ENV_CHUNK);
+            pool.submit([fn, first, last] { fn(first, last); });
+        }
+        pool.wait();
+    }
+};
+
+static void WriteObs(const TableSim &sim, const TurnState &t, float *obs) {
+    const Rectangle &play = sim.layout.play;
+    std::fill(obs, obs + ENV_BALLS*3, 0.0f);
+    for (auto &b : sim.balls) {
+        if (b.id < 0 || b.id >= ENV_BALLS || !b.active) continue;
+        float *o = obs + b.id*3;
+        o[0] = (b.pos.x - play.x) / play.width;
+        o[1] = (b.pos.y - play.y) / play.height;
+        o[2] = 1.0f;
+    }
+    float *o = obs + ENV_BALLS*3;
+    o[0] = (float)t.currentPlayer;
+    o[1] = (float)t.score[1];
+    o[2] = (float)t.score[2];
+    o[3] = t.waitingPlacement ? 1.0f : 0.0f;
+}
+
+// One shot as the game plays it: ball in hand first, then ticks until the
+// turn is settled and the table is still (the observation never has moving
+// balls). Balls that drop while the table settles count for whoever has the
+// turn by then, as in the game.
+static float PlayShot(TableSim &sim, TurnState &t, const EnvAction &a) {
+    const int shooter = t.currentPlayer;
+    const int before = t.score[shooter];
+    if (t.waitingPlacement) {
+        const Rectangle &play = sim.layout.play;
+        Vector2 p = { play.x + clampf_custom(a.placeX, 0.0f, 1.0f) * play.width, play.y + clampf_custom(a.placeY, 0.0f, 1.0f) * play.height };
+        if (!sim.placeCueBall(p)) sim.spotCueBall();
+        t.waitingPlacement = false;
+    }
+    // shoot() takes the mouse aim, which points away from the travel direction
+    sim.shoot(a.angle + 3.14159265f, clampf_custom(a.power, 0.0f, MAX_POWER));
+    t.shotInProgress = true;
+    t.slowTimer = 0.0f;
+    for (int tick=0; tick<ENV_MAX_TICKS && !t.gameOver && (t.shotInProgress || !sim.sleeping); tick++)
+        RulesTick(sim, t, GAME_SUBSTEPS, GAME_TICK_DT);
+    t.shotInProgress = false;
+
+    float reward = (float)(t.score[shooter] - before);
+    if (t.gameOver) reward += t.winner == shooter ? ENV_WIN_REWARD : -ENV_WIN_REWARD;
+    return reward;
+}
+
+EnvBatch *EnvBatchCreate(int tables, int threads) {
+    if (tables <= 0) return nullptr;
+    EnvBatch *env = new EnvBatch(tables, threads);
+    for (int i=0;i<tables;i++) NewGame(env->sims[i], env->turns[i]);
+    return env;
+}
+
+void EnvBatchDestroy(EnvBatch *env) {
+    delete env;
+}
+
+int EnvBatchSize(const EnvBatch *env) {
+    return (int)env->sims.size();
+}
+
+void EnvBatchReset(EnvBatch *env, float *obs) {
+    env->forChunks([env, obs](int first, int last) {
+        for (int i=first;i<last;i++) {
+            NewGame(env->sims[i], env->turns[i]);
+            WriteObs(env->sims[i], env->turns[i], obs + (size_t)i*ENV_OBS_FLOATS);
+        }
+    });
+}
+
+void EnvBatchStep(EnvBatch *env, const EnvAction *actions, float *obs, float *rewards, unsigned char *dones) {
+    env->forChunks([=](int first, int last) {
+        for (int i=first;i<last;i++) {
+            TableSim &sim = env->sims[i];
+            TurnState &t = env->turns[i];
+            rewards[i] = PlayShot(sim, t, actions[i]);
+            dones[i] = t.gameOver ? 1 : 0;
+            if (t.gameOver) NewGame(sim, t);
+            WriteObs(sim, t, obs + (size_t)i*ENV_OBS_FLOATS);
+        }
+    });
+}
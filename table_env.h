@@ -0,0 +1,54 @@
+/* Batched 8-ball tables behind a plain C ABI, for training shot selection
+ * offline. Every table runs the game's own physics and turn rules (RulesTick
+ * at the game's 60 Hz tick and substeps); one step is one shot per table.
+ *
+ * Observations, rewards and done flags are written straight into buffers the
+ * caller owns, laid out table after table, and the batch is split over a
+ * thread pool. Tables are independent and deterministic, so results never
+ * depend on the thread count.
+ *
+ * Shared library:
+ *   g++ -O2 -shared -fPIC table_env.cpp table_sim.cpp contact_solver.cpp table_events.cpp game_rules.cpp game_snapshot.cpp thread_pool.cpp profiler.cpp -o libtable_env.so -lpthread
+ */
+
+#ifndef TABLE_ENV_H
+#define TABLE_ENV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENV_BALLS 16
+/* per ball, indexed by id: x, y (0..1 across the play area), on the table (0/1);
+ * then the player to move (1/2), player 1 score, player 2 score, ball in hand (0/1) */
+#define ENV_OBS_FLOATS (ENV_BALLS * 3 + 4)
+/* added to the shooter's reward when the 8 ends the game */
+#define ENV_WIN_REWARD 10.0f
+
+typedef struct EnvBatch EnvBatch;
+
+typedef struct EnvAction {
+    float angle;           /* direction the cue ball travels, radians */
+    float power;           /* 0..MAX_POWER (20) */
+    float placeX, placeY;  /* ball in hand, 0..1 across the play area; used only then */
+} EnvAction;
+
+/* threads <= 0 uses every hardware thread; NULL when tables <= 0 */
+EnvBatch *EnvBatchCreate(int tables, int threads);
+void EnvBatchDestroy(EnvBatch *env);
+int EnvBatchSize(const EnvBatch *env);
+
+/* Re-racks every table and writes obs[tables * ENV_OBS_FLOATS]. */
+void EnvBatchReset(EnvBatch *env, float *obs);
+
+/* Plays actions[i] on table i and runs it until the shot's turn is settled
+ * and the balls are at rest. rewards[i] is the shooter's score change, plus
+ * or minus ENV_WIN_REWARD when the game ended. A finished table reports
+ * dones[i] = 1 and is re-racked, so its observation is the new game. */
+void EnvBatchStep(EnvBatch *env, const EnvAction *actions, float *obs, float *rewards, unsigned char *dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
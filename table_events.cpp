@@ -0,0 +1,223 @@
+// Event-driven (continuous) stepping for TableSim.
+//
+// Between events every moving ball keeps its direction and its speed decays
+// by FRICTION per frame, so after tau frames a ball has travelled
+//   vel * (1 - FRICTION^tau) / (1 - FRICTION)
+// which equals the per-frame sum of step() at whole frames. All balls share
+// that travel factor u(tau), so relative motion is linear in u and every time
+// of impact is a closed-form root.
+
+#include "table_sim.h"
+#include "profiler.h"
+#include <cfloat>
+
+namespace {
+
+const double NEVER = DBL_MAX;
+const double EPS = 1e-4;
+const float IMPACT_TOUCH = 0.01f;   // pixels: pairs this close count as touching at an impact
+
+enum EventType { EV_NONE, EV_BALL, EV_SEGMENT, EV_POCKET, EV_STOP };
+
+struct Event {
+    EventType type;
+    double tau;     // frames from now
+    int i, j;       // ball index, and other ball / segment / hole
+};
+
+double TravelFactor(double tau) { return (1.0 - pow((double)FRICTION, tau)) / (1.0 - FRICTION); }
+
+double TimeForTravel(double u) {
+    double x = 1.0 - u * (1.0 - FRICTION);
+    if (x <= 0.0) return NEVER;
+    return log(x) / log((double)FRICTION);
+}
+
+bool Moving(const Ball &b) { return b.active && (b.vel.x != 0.0f || b.vel.y != 0.0f); }
+
+// Smallest u >= 0 at which p0 + w*u enters the circle of radius D around the
+// origin. Already inside and still approaching counts as an immediate hit.
+double EnterCircle(double px, double py, double wx, double wy, double D) {
+    double a = wx*wx + wy*wy;
+    if (a <= 1e-12) return NEVER;
+    double b = 2.0 * (px*wx + py*wy);
+    double c = px*px + py*py - D*D;
+    if (c <= 0.0) return (b < 0.0) ? 0.0 : NEVER;
+    if (b >= 0.0) return NEVER;
+    double disc = b*b - 4.0*a*c;
+    if (disc < 0.0) return NEVER;
+    return (-b - sqrt(disc)) / (2.0*a);
+}
+
+// Ball centre vs the capsule of radius r around a cushion segment, up to uLimit.
+double EnterCapsule(const Vector2 &p, const Vector2 &v, const Segment &s, double r, double uLimit) {
+    double dx = s.b.x - s.a.x, dy = s.b.y - s.a.y;
+    double L = sqrt(dx*dx + dy*dy);
+    double best = NEVER;
+    if (L > 1e-9) {
+        double tx = dx/L, ty = dy/L, nx = -ty, ny = tx;
+        double s0 = (p.x - s.a.x)*nx + (p.y - s.a.y)*ny;
+        double sv = v.x*nx + v.y*ny;
+        // the whole capsule, ends included, lies within r of the line
+        if (fabs(s0) >= r && (s0*sv >= 0.0 || fabs(s0) - r > fabs(sv)*uLimit)) return NEVER;
+        double u = NEVER;
+        if (s0 >= r && sv < 0.0) u = (s0 - r) / -sv;
+        else if (s0 <= -r && sv > 0.0) u = (-r - s0) / sv;
+        else if (fabs(s0) < r && s0*sv < 0.0) u = 0.0;
+        if (u != NEVER) {
+            double along = (p.x + v.x*u - s.a.x)*tx + (p.y + v.y*u - s.a.y)*ty;
+            if (along >= 0.0 && along <= L) best = u;
+        }
+    }
+    best = fmin(best, EnterCircle(p.x - s.a.x, p.y - s.a.y, v.x, v.y, r));
+    best = fmin(best, EnterCircle(p.x - s.b.x, p.y - s.b.y, v.x, v.y, r));
+    return best;
+}
+
+void Consider(Event &best, EventType type, double u, double uLimit, int i, int j) {
+    if (u == NEVER || u > uLimit) return;
+    double tau = TimeForTravel(u);
+    if (tau < best.tau) best = { type, tau, i, j };
+}
+
+} // namespace
+
+static Event NextEvent(const TableSim &sim) {
+    PROFILE_SCOPE(PROF_TOI);
+    const TableLayout &L = sim.layout;
+    const std::vector<Ball> &balls = sim.balls;
+    Event best = { EV_NONE, NEVER, -1, -1 };
+
+    // Nothing is predicted past the first ball coming to rest, since that
+    // changes the shared motion model; the stop itself is the event.
+    for (size_t i=0;i<balls.size();++i) {
+        const Ball &b = balls[i];
+        if (!Moving(b)) continue;
+        double speed = sqrt((double)b.vel.x*b.vel.x + (double)b.vel.y*b.vel.y);
+        double tau = (speed <= MIN_VEL) ? 0.0 : log(MIN_VEL / speed) / log((double)FRICTION);
+        if (tau < best.tau) best = { EV_STOP, tau, (int)i, -1 };
+    }
+    if (best.type == EV_NONE) return best;
+    double uLimit = TravelFactor(best.tau);
+
+    for (size_t i=0;i<balls.size();++i) {
+        const Ball &b = balls[i];
+        if (!b.active) continue;
+        bool moving = Moving(b);
+
+        for (size_t j=i+1;j<balls.size();++j) {
+            const Ball &o = balls[j];
+            if (!o.active || (!moving && !Moving(o))) continue;
+            double u = EnterCircle(o.pos.x - b.pos.x, o.pos.y - b.pos.y, o.vel.x - b.vel.x, o.vel.y - b.vel.y, 2.0*L.ballR);
+            Consider(best, EV_BALL, u, uLimit, (int)i, (int)j);
+        }
+        if (!moving) continue;
+
+        // the boundary field bounds how close the nearest cushion is, so a
+        // ball that cannot reach one before uLimit skips them all
+        double reach = sqrt((double)b.vel.x*b.vel.x + (double)b.vel.y*b.vel.y) * uLimit;
+        if (L.field->clearance(b.pos) <= reach + EPS)
+            for (size_t s=0;s<L.cushions.size();++s)
+                Consider(best, EV_SEGMENT, EnterCapsule(b.pos, b.vel, L.cushions[s], L.ballR, uLimit), uLimit, (int)i, (int)s);
+
+        for (int h=0;h<L.config.pockets;h++)
+            Consider(best, EV_POCKET, EnterCircle(b.pos.x - L.holes[h].x, b.pos.y - L.holes[h].y, b.vel.x, b.vel.y, L.holeR - 4.0f), uLimit, (int)i, h);
+    }
+    return best;
+}
+
+static void Drift(std::vector<Ball> &balls, double tau) {
+    if (tau <= 0.0) return;
+    PROFILE_SCOPE(PROF_INTEGRATE);
+    float u = (float)TravelFactor(tau);
+    float decay = (float)pow((double)FRICTION, tau);
+    for (auto &b : balls) {
+        if (!Moving(b)) continue;
+        b.restSteps = 0;
+        b.pos.x += b.vel.x * u;
+        b.pos.y += b.vel.y * u;
+        b.vel.x *= decay;
+        b.vel.y *= decay;
+    }
+}
+
+static void ApplyEvent(TableSim &sim, const Event &e) {
+    PROFILE_SCOPE(PROF_RESOLVE);
+    const TableLayout &L = sim.layout;
+    Ball &b = sim.balls[e.i];
+    switch (e.type) {
+    case EV_BALL:
+        // Contact is exact, so only impulses apply. Every other pair touching
+        // at this instant (a ball meeting two at once) bounces in the same
+        // solve rather than in index order.
+        sim.resolveImpacts(IMPACT_TOUCH);
+        break;
+    case EV_SEGMENT: {
+        const Segment &seg = L.cushions[e.j];
+        float t; Vector2 cp = ClosestPointOnSegment(seg.a, seg.b, b.pos, t);
+        float nx = b.pos.x - cp.x, ny = b.pos.y - cp.y;
+        float nlen = sqrtf(nx*nx + ny*ny);
+        if (nlen < 1e-6f) break;
+        nx /= nlen; ny /= nlen;
+        float vdot = b.vel.x*nx + b.vel.y*ny;
+        if (vdot >= 0.0f) break;
+        b.vel.x -= 2.0f * vdot * nx;
+        b.vel.y -= 2.0f * vdot * ny;
+        b.vel.x *= RESTITUTION; b.vel.y *= RESTITUTION;
+        break;
+    }
+    case EV_POCKET:
+        sim.pocketed.push_back(b.id);
+        sim.shotPocketed.push_back(b.id);
+        if (b.id != 0) { b.active = false; b.vel = {0,0}; }
+        else sim.spotCueBall();
+        break;
+    case EV_STOP:
+        b.vel = {0,0};
+        break;
+    case EV_NONE:
+        break;
+    }
+    // same cut-off as step() so nothing crawls forever after an impact
+    for (auto &o : sim.balls)
+        if (o.active && o.vel.x*o.vel.x + o.vel.y*o.vel.y < MIN_VEL*MIN_VEL) o.vel = {0,0};
+}
+
+// Runs events for up to `frames`; returns the time actually simulated.
+static double RunEvents(TableSim &sim, double frames, bool stopAtRest) {
+    double elapsed = 0.0;
+    // bounds zero-time cascades (e.g. a ball pinned between two others)
+    int guard = 0;
+    while (elapsed < frames) {
+        Event e = NextEvent(sim);
+        if (e.type == EV_NONE) {
+            if (stopAtRest) break;
+            elapsed = frames;
+            break;
+        }
+        double left = frames - elapsed;
+        if (e.tau >= left) { Drift(sim.balls, left); elapsed = frames; break; }
+        if (e.tau > 0.0) guard = 0;
+        else if (++guard > 256) { Drift(sim.balls, fmin(left, 1e-3)); elapsed += fmin(left, 1e-3); continue; }
+        Drift(sim.balls, e.tau);
+        elapsed += e.tau;
+        ApplyEvent(sim, e);
+        sim.events++;
+    }
+    return elapsed;
+}
+
+void TableSim::advance(float frames) {
+    reserveScratch();
+    pocketed.clear();
+    RunEvents(*this, frames, false);
+    sleeping = atRest();
+}
+
+float TableSim::advanceUntilRest(float maxFrames) {
+    reserveScratch();
+    pocketed.clear();
+    float t = (float)RunEvents(*this, maxFrames, true);
+    sleeping = atRest();
+    return t;
+}
@@ -0,0 +1,75 @@
+#include "table_hash.h"
+
+// splitmix64 finalizer: turns a feature id into its key, so the keys need no
+// table and are the same on every machine
+static uint64_t Mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static uint32_t Bucket(float v) { return (uint32_t)(int32_t)lroundf(v / HASH_QUANTUM); }
+
+uint64_t BallKey(const Ball &b) {
+    uint64_t id = (uint64_t)(uint32_t)b.id << 1;
+    if (!b.active) return Mix(id | 1);
+    return Mix(Mix(id) ^ (((uint64_t)Bucket(b.pos.x) << 32) | Bucket(b.pos.y)));
+}
+
+uint64_t TurnKey(int currentPlayer, bool waitingPlacement) {
+    return Mix(0x7475726eull << 8 | (uint64_t)(currentPlayer & 0x7f) << 1 | (waitingPlacement ? 1 : 0));
+}
+
+uint64_t BallsHash(const std::vector<Ball> &balls) {
+    uint64_t h = 0;
+    for (auto &b : balls) h ^= BallKey(b);
+    return h;
+}
+
+uint64_t TableHash(const TableSim &sim, const TurnState &turn) {
+    return BallsHash(sim.balls) ^ TurnKey(turn.currentPlayer, turn.waitingPlacement);
+}
+
+uint64_t ShotKey(uint64_t state, float angle, float power) {
+    const float PI_F = 3.14159265f;
+    float a = angle - 2.0f*PI_F*floorf((angle + PI_F) / (2.0f*PI_F));   // into [-pi, pi)
+    uint64_t qa = (uint64_t)lroundf((a + PI_F) * (65536.0f / (2.0f*PI_F))) & 0xffff;
+    uint64_t qp = (uint64_t)lroundf(clampf_custom(power / MAX_POWER, 0.0f, 1.0f) * 65535.0f);
+    uint64_t k = Mix(state ^ Mix(qa << 16 | qp));
+    return k ? k : 1;
+}
+
+// ---------------- cache ----------------
+
+ShotCache::ShotCache(size_t capacity) {
+    size_t n = 1;
+    while (n < capacity) n <<= 1;
+    slots.assign(n, Slot{ 0, CachedShot() });
+    mask = n - 1;
+}
+
+bool ShotCache::find(uint64_t key, CachedShot &out) const {
+    size_t i = key & mask;
+    {
+        std::lock_guard<std::mutex> lock(stripes[i % STRIPES]);
+        if (slots[i].key == key) { out = slots[i].value; hitCount++; return true; }
+    }
+    missCount++;
+    return false;
+}
+
+void ShotCache::store(uint64_t key, const CachedShot &value) {
+    size_t i = key & mask;
+    std::lock_guard<std::mutex> lock(stripes[i % STRIPES]);
+    slots[i] = { key, value };
+}
+
+void ShotCache::clear() {
+    for (size_t i=0;i<slots.size();i++) {
+        std::lock_guard<std::mutex> lock(stripes[i % STRIPES]);
+        slots[i].key = 0;
+    }
+    hitCount = 0;
+    missCount = 0;
+}
@@ -0,0 +1,68 @@
+// Zobrist-style table hashing and a shot-outcome transposition cache.
+// Every feature of a state (one ball's quantized position or its being off
+// the table, whose turn it is, ball in hand) has its own 64-bit key, and a
+// state hashes to the XOR of its features' keys. Ball order does not matter,
+// and moving one ball updates a hash with two XORs:
+//   h ^= BallKey(before) ^ BallKey(after);
+// Positions are bucketed to HASH_QUANTUM, so two simulations that agree to
+// within that hash the same and any larger drift shows up as a mismatch.
+// Velocities are not hashed: states are meant to be tables at rest.
+
+#ifndef TABLE_HASH_H
+#define TABLE_HASH_H
+
+#include "table_sim.h"
+#include "game_rules.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+const float HASH_QUANTUM = 1.0f / 64.0f;   // table pixels per position bucket
+
+uint64_t BallKey(const Ball &b);
+uint64_t TurnKey(int currentPlayer, bool waitingPlacement);
+
+// the balls alone (all a shot's physics depends on)
+uint64_t BallsHash(const std::vector<Ball> &balls);
+// balls plus currentPlayer and waitingPlacement
+uint64_t TableHash(const TableSim &sim, const TurnState &turn);
+
+// A shot from a hashed state; angle and power are quantized to 16 bits as on
+// the network, so a repeated candidate lands on the same key.
+uint64_t ShotKey(uint64_t state, float angle, float power);
+
+struct CachedShot {
+    ShotOutcome outcome;
+    uint64_t after = 0;   // BallsHash of the table the shot left at rest
+};
+
+// Bounded map from ShotKey to outcome, safe to share between threads. Slots
+// are direct-mapped (a new entry evicts whatever held its slot) and guarded
+// by a few striped locks, so lookups from the search threads rarely contend.
+class ShotCache {
+public:
+    // capacity is rounded up to a power of two
+    explicit ShotCache(size_t capacity = 1 << 16);
+    ShotCache(const ShotCache &) = delete;
+    ShotCache &operator=(const ShotCache &) = delete;
+
+    bool find(uint64_t key, CachedShot &out) const;
+    void store(uint64_t key, const CachedShot &value);
+    void clear();
+
+    size_t capacity() const { return slots.size(); }
+    long hits() const { return hitCount; }
+    long misses() const { return missCount; }
+
+private:
+    struct Slot { uint64_t key; CachedShot value; };   // key 0 = empty
+    static const int STRIPES = 64;
+
+    std::vector<Slot> slots;
+    size_t mask;
+    mutable std::mutex stripes[STRIPES];
+    mutable std::atomic<long> hitCount{0}, missCount{0};
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "table_query.h"
+
+// First root of |start + dir*t - c| = R with t in [0, maxDist]
+static bool RayCircleT(const Vector2 &start, const Vector2 &dir, float maxDist, const Vector2 &c, float R, float &tOut) {
+    float mx = start.x - c.x, my = start.y - c.y;
+    float b = mx*dir.x + my*dir.y;
+    float cc = mx*mx + my*my - R*R;
+    if (cc <= 0.0f) { tOut = 0.0f; return true; }
+    if (b > 0.0f) return false;
+    float disc = b*b - cc;
+    if (disc < 0.0f) return false;
+    float t = -b - sqrtf(disc);
+    if (t > maxDist) return false;
+    tOut = fmaxf(t, 0.0f);
+    return true;
+}
+
+bool SweepCircleVsCircle(const Vector2 &start, const Vector2 &dir, float maxDist, float radius, const Vector2 &center, float targetRadius, SweepHit &out) {
+    float t;
+    if (!RayCircleT(start, dir, maxDist, center, radius + targetRadius, t)) return false;
+    out.dist = t;
+    out.center = { start.x + dir.x*t, start.y + dir.y*t };
+    float nx = out.center.x - center.x, ny = out.center.y - center.y;
+    float len = sqrtf(nx*nx + ny*ny);
+    out.normal = (len > 1e-6f) ? Vector2{ nx/len, ny/len } : Vector2{ -dir.x, -dir.y };
+    out.point = { center.x + out.normal.x*targetRadius, center.y + out.normal.y*targetRadius };
+    return true;
+}
+
+bool SweepCircleVsSegment(const Vector2 &start, const Vector2 &dir, float maxDist, float radius, const Segment &seg, SweepHit &out) {
+    float dx = seg.b.x - seg.a.x, dy = seg.b.y - seg.a.y;
+    float L = sqrtf(dx*dx + dy*dy);
+    float best = maxDist + 1.0f;
+    bool hit = false;
+
+    // flat side of the capsule
+    if (L > 1e-6f) {
+        float tx = dx/L, ty = dy/L;
+        float nx = -ty, ny = tx;
+        float s0 = (start.x - seg.a.x)*nx + (start.y - seg.a.y)*ny;
+        float sd = dir.x*nx + dir.y*ny;
+        // the whole capsule, ends included, lies within radius of the line
+        if (fabsf(s0) > radius && (s0*sd >= 0.0f || fabsf(s0) - radius > fabsf(sd)*maxDist)) return false;
+        float t = -1.0f;
+        if (fabsf(s0) <= radius) t = 0.0f;
+        else if (s0*sd < 0.0f) t = (fabsf(s0) - radius) / fabsf(sd);
+        if (t >= 0.0f && t <= maxDist) {
+            float along = (start.x + dir.x*t - seg.a.x)*tx + (start.y + dir.y*t - seg.a.y)*ty;
+            if (along >= 0.0f && along <= L) { best = t; hit = true; }
+        }
+    }
+    // rounded ends
+    float t;
+    if (RayCircleT(start, dir, maxDist, seg.a, radius, t) && t < best) { best = t; hit = true; }
+    if (RayCircleT(start, dir, maxDist, seg.b, radius, t) && t < best) { best = t; hit = true; }
+    if (!hit) return false;
+
+    out.dist = best;
+    out.center = { start.x + dir.x*best, start.y + dir.y*best };
+    float u; out.point = ClosestPointOnSegment(seg.a, seg.b, out.center, u);
+    float nx = out.center.x - out.point.x, ny = out.center.y - out.point.y;
+    float len = sqrtf(nx*nx + ny*ny);
+    out.normal = (len > 1e-6f) ? Vector2{ nx/len, ny/len } : Vector2{ -dir.x, -dir.y };
+    return true;
+}
@@ -0,0 +1,21 @@
+// Closed-form swept-circle queries (aim preview, shot planning).
+
+#ifndef TABLE_QUERY_H
+#define TABLE_QUERY_H
+
+#include "table_sim.h"
+
+struct SweepHit {
+    float dist;      // distance the moving centre travelled along dir
+    Vector2 center;  // moving centre at first contact
+    Vector2 point;   // contact point on the target's surface
+    Vector2 normal;  // unit surface normal at point, facing the moving circle
+};
+
+// A circle of `radius` moving from start along unit dir for at most maxDist.
+// Starting in contact reports dist 0.
+bool SweepCircleVsCircle(const Vector2 &start, const Vector2 &dir, float maxDist, float radius, const Vector2 &center, float targetRadius, SweepHit &out);
+// Target is the segment itself, i.e. a capsule of `radius` around it.
+bool SweepCircleVsSegment(const Vector2 &start, const Vector2 &dir, float maxDist, float radius, const Segment &seg, SweepHit &out);
+
+#endif
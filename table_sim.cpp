@@ -0,0 +1,506 @@
+#include "table_sim.h"
+#include "profiler.h"
+#include <algorithm>
+
+Vector2 ClosestPointOnSegment(const Vector2 &a, const Vector2 &b, const Vector2 &p, float &tOut) {
+    Vector2 ab = {b.x-a.x, b.y-a.y};
+    Vector2 ap = {p.x-a.x, p.y-a.y};
+    float ab2 = ab.x*ab.x + ab.y*ab.y;
+    if (ab2 <= 1e-8f) { tOut = 0.0f; return a; }
+    float t = Dot(ap, ab) / ab2;
+    tOut = clampf_custom(t, 0.0f, 1.0f);
+    return { a.x + ab.x * tOut, a.y + ab.y * tOut };
+}
+
+void ResolveBallCollision(Ball &A, Ball &B, float r) {
+    if (!A.active || !B.active) return;
+    Vector2 n = { B.pos.x - A.pos.x, B.pos.y - A.pos.y };
+    float d = sqrtf(n.x*n.x + n.y*n.y);
+    if (d <= 1e-6f || d >= 2.0f*r) return;
+    A.restSteps = B.restSteps = 0;
+    Vector2 norm = { n.x/d, n.y/d };
+    float overlap = 2.0f*r - d;
+    A.pos.x -= norm.x * overlap * 0.5f; A.pos.y -= norm.y * overlap * 0.5f;
+    B.pos.x += norm.x * overlap * 0.5f; B.pos.y += norm.y * overlap * 0.5f;
+    Vector2 rv = { B.vel.x - A.vel.x, B.vel.y - A.vel.y };
+    float velAlongNormal = rv.x*norm.x + rv.y*norm.y;
+    if (velAlongNormal > 0) return;
+    float e = RESTITUTION;
+    float j = -(1.0f + e) * velAlongNormal;
+    j /= 2.0f;
+    Vector2 imp = { j*norm.x, j*norm.y };
+    A.vel.x -= imp.x; A.vel.y -= imp.y;
+    B.vel.x += imp.x; B.vel.y += imp.y;
+}
+
+static const TableConfig *const TABLE_CONFIGS[] = { &TABLE_8BALL, &TABLE_9BALL, &TABLE_4POCKET, &TABLE_SNOOKER };
+
+const TableConfig *FindTableConfig(const char *name) {
+    for (const TableConfig *c : TABLE_CONFIGS) if (std::string(c->name) == name) return c;
+    return nullptr;
+}
+
+std::string TableConfigNames() {
+    std::string names;
+    for (const TableConfig *c : TABLE_CONFIGS) names += (names.empty() ? "" : "|") + std::string(c->name);
+    return names;
+}
+
+TableLayout MakeTableLayout(const TableConfig &config, int screenW, int screenH, float ballScale) {
+    TableLayout L;
+    L.config = config;
+
+    // Table fill most of window - preserve ratio
+    const float TABLE_ASPECT = config.aspect;
+    const float PAD = 40.0f;
+    float availW = screenW - PAD*2;
+    float availH = screenH - PAD*2;
+    float tableW = availW;
+    float tableH = tableW / TABLE_ASPECT;
+    if (tableH > availH) { tableH = availH; tableW = tableH * TABLE_ASPECT; }
+    L.table = { (screenW - tableW)/2.0f, (screenH - tableH)/2.0f, tableW, tableH };
+    const Rectangle &T = L.table;
+    L.play = { T.x + CUSHION_OFFSET, T.y + CUSHION_OFFSET, T.width - 2.0f*CUSHION_OFFSET, T.height - 2.0f*CUSHION_OFFSET };
+
+    // scale derived
+    L.scale = T.width / 840.0f;
+    L.ballR = config.ballR * L.scale * ballScale;
+    L.holeR = config.holeR * L.scale * ballScale;
+
+    // pockets: corners and, on a six-pocket table, the middle of each long rail
+    float hr = L.holeR;
+    const bool sides = config.pockets == 6;
+    Vector2 *hole = L.holes;
+    *hole++ = { T.x + hr*0.7f, T.y + hr*0.7f };
+    if (sides) *hole++ = { T.x + T.width*0.5f, T.y + hr*0.7f };
+    *hole++ = { T.x + T.width - hr*0.7f, T.y + hr*0.7f };
+    *hole++ = { T.x + hr*0.7f, T.y + T.height - hr*0.7f };
+    if (sides) *hole++ = { T.x + T.width*0.5f, T.y + T.height - hr*0.7f };
+    *hole++ = { T.x + T.width - hr*0.7f, T.y + T.height - hr*0.7f };
+
+    // Create cushions (segments) with cutouts for pockets (funnel shape).
+    // Every rail end gets a jaw out to the table edge: 45 degrees into the
+    // corner pockets, slightly narrowing into the side pockets.
+    float left = L.play.x, right = L.play.x + L.play.width;
+    float top = L.play.y, bot = L.play.y + L.play.height;
+    float edgeR = T.x + T.width, edgeB = T.y + T.height;
+    float cut = hr * 1.2f;
+    float cj = CUSHION_OFFSET, sj = CUSHION_OFFSET * 0.25f;
+    // corners: top left, top right, bottom left, bottom right
+    const Vector2 TL = L.holes[0], TR = L.holes[sides ? 2 : 1], BL = L.holes[sides ? 3 : 2], BR = L.holes[sides ? 5 : 3];
+    // walked round the table; the gaps between rails are the pocket mouths,
+    // closed along the table edge
+    std::vector<Vector2> outline;
+    auto rail = [&](Vector2 jawA, Vector2 a, Vector2 b, Vector2 jawB) {
+        L.cushions.push_back({ jawA, a });
+        L.cushions.push_back({ a, b });
+        L.cushions.push_back({ b, jawB });
+        outline.insert(outline.end(), { jawA, a, b, jawB });
+    };
+    outline.push_back({ T.x, T.y });
+    if (sides) {
+        const Vector2 TM = L.holes[1];
+        rail({ TL.x + cut - cj, T.y }, { TL.x + cut, top }, { TM.x - cut, top }, { TM.x - cut + sj, T.y });
+        rail({ TM.x + cut - sj, T.y }, { TM.x + cut, top }, { TR.x - cut, top }, { TR.x - cut + cj, T.y });
+    } else {
+        rail({ TL.x + cut - cj, T.y }, { TL.x + cut, top }, { TR.x - cut, top }, { TR.x - cut + cj, T.y });
+    }
+    outline.push_back({ edgeR, T.y });
+    rail({ edgeR, TR.y + cut - cj }, { right, TR.y + cut }, { right, BR.y - cut }, { edgeR, BR.y - cut + cj });
+    outline.push_back({ edgeR, edgeB });
+    if (sides) {
+        const Vector2 BM = L.holes[4];
+        rail({ BR.x - cut + cj, edgeB }, { BR.x - cut, bot }, { BM.x + cut, bot }, { BM.x + cut - sj, edgeB });
+        rail({ BM.x - cut + sj, edgeB }, { BM.x - cut, bot }, { BL.x + cut, bot }, { BL.x + cut - cj, edgeB });
+    } else {
+        rail({ BR.x - cut + cj, edgeB }, { BR.x - cut, bot }, { BL.x + cut, bot }, { BL.x + cut - cj, edgeB });
+    }
+    outline.push_back({ T.x, edgeB });
+    rail({ T.x, BL.y - cut + cj }, { left, BL.y - cut }, { left, TL.y + cut }, { T.x, TL.y + cut - cj });
+
+    auto field = std::make_shared<TableField>();
+    field->build(L, outline);
+    L.field = field;
+    return L;
+}
+
+// ---------------- boundary field ----------------
+
+static bool InsideOutline(const std::vector<Vector2> &poly, Vector2 p) {
+    bool in = false;
+    for (size_t i=0, j=poly.size()-1; i<poly.size(); j=i++) {
+        const Vector2 &a = poly[i], &b = poly[j];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) in = !in;
+    }
+    return in;
+}
+
+// exact signed distance to the cushions (positive on the cloth side) and its gradient
+static float SignedCushionDistance(const TableLayout &L, const std::vector<Vector2> &outline, Vector2 p, Vector2 &grad) {
+    float best = 1e30f;
+    Vector2 cp = p;
+    const Segment *nearest = nullptr;
+    for (auto &s : L.cushions) {
+        float t; Vector2 c = ClosestPointOnSegment(s.a, s.b, p, t);
+        float d = Dist(c, p);
+        if (d < best) { best = d; cp = c; nearest = &s; }
+    }
+    float sign = InsideOutline(outline, p) ? 1.0f : -1.0f;
+    if (best > 1e-4f) {
+        grad = { sign * (p.x - cp.x) / best, sign * (p.y - cp.y) / best };
+    } else if (nearest) {
+        // on the cushion itself: its normal, turned towards the cloth
+        float len = Dist(nearest->a, nearest->b);
+        Vector2 n = { -(nearest->b.y - nearest->a.y) / len, (nearest->b.x - nearest->a.x) / len };
+        if (!InsideOutline(outline, { cp.x + n.x*0.01f, cp.y + n.y*0.01f })) n = { -n.x, -n.y };
+        grad = n;
+    }
+    return sign * best;
+}
+
+void TableField::build(const TableLayout &L, const std::vector<Vector2> &outline) {
+    pocketCount = L.config.pockets;
+    for (int h=0;h<pocketCount;h++) holes[h] = L.holes[h];
+    captureR = L.holeR - 4.0f;
+    const float R = L.ballR;
+    spacing = fmaxf(R * 0.25f, 0.25f);
+    inv = 1.0f / spacing;
+    origin = { L.table.x - 2.0f*R, L.table.y - 2.0f*R };
+    const float tileSize = TILE * spacing;
+    tilesX = (int)ceilf((L.table.width + 4.0f*R) / tileSize) + 1;
+    tilesY = (int)ceilf((L.table.height + 4.0f*R) / tileSize) + 1;
+    tileSlot.assign(tilesX*tilesY, -1);
+    tileFloor.assign(tilesX*tilesY, 0.0f);
+    nodes.clear();
+
+    // A tile holds the points whose nearest node is in it: a square TILE
+    // spacings wide around its centre. Distance changes no faster than
+    // position, so the centre alone shows whether any of it can touch.
+    const float halfDiag = 0.5f * tileSize * 1.41422f;
+    for (int ty=0; ty<tilesY; ty++)
+        for (int tx=0; tx<tilesX; tx++) {
+            Vector2 c = { origin.x + (tx*TILE + 0.5f*(TILE-1))*spacing, origin.y + (ty*TILE + 0.5f*(TILE-1))*spacing };
+            Vector2 g;
+            float lower = SignedCushionDistance(L, outline, c, g) - R - halfDiag;
+            bool nearHole = false;
+            for (int h=0;h<pocketCount;h++) if (Dist(c, holes[h]) < captureR + halfDiag) nearHole = true;
+            int t = ty*tilesX + tx;
+            if (lower > 0.0f && !nearHole) { tileFloor[t] = lower; continue; }
+
+            tileSlot[t] = (int)(nodes.size() / TILE_NODES);
+            for (int y=0; y<TILE; y++)
+                for (int x=0; x<TILE; x++) {
+                    Vector2 p = { origin.x + (tx*TILE + x)*spacing, origin.y + (ty*TILE + y)*spacing };
+                    Node n;
+                    Vector2 grad = { 0, 0 };
+                    n.d = SignedCushionDistance(L, outline, p, grad) - R;
+                    n.nx = grad.x; n.ny = grad.y;
+                    // any point rounding to this node is within spacing/sqrt(2) of it
+                    n.pocket = -1;
+                    for (int h=0;h<pocketCount;h++) if (Dist(p, holes[h]) < captureR + spacing*0.7072f) n.pocket = (int8_t)h;
+                    nodes.push_back(n);
+                }
+        }
+}
+
+void BallGrid::candidatePairs(const std::vector<Ball> &balls, const Rectangle &bounds, float dist, std::vector<int> &pairs) {
+    const int n = (int)balls.size();
+    const float cell = fmaxf(dist, 1e-3f);
+    cols = std::max(1, (int)(bounds.width / cell) + 1);
+    rows = std::max(1, (int)(bounds.height / cell) + 1);
+    cellOf.resize(n);
+    cellStart.assign(cols*rows + 1, 0);
+    order.resize(n);
+
+    // counting sort by cell; balls off the grid land in the border cells
+    for (int i=0;i<n;i++) {
+        if (!balls[i].active) { cellOf[i] = -1; continue; }
+        int cx = std::min(cols-1, std::max(0, (int)((balls[i].pos.x - bounds.x) / cell)));
+        int cy = std::min(rows-1, std::max(0, (int)((balls[i].pos.y - bounds.y) / cell)));
+        cellOf[i] = cy*cols + cx;
+        cellStart[cellOf[i]]++;
+    }
+    for (int c=1;c<=cols*rows;c++) cellStart[c] += cellStart[c-1];
+    for (int i=n-1;i>=0;i--) if (cellOf[i] >= 0) order[--cellStart[cellOf[i]]] = i;
+
+    size_t first = pairs.size();
+    const float d2 = dist*dist;
+    for (int i=0;i<n;i++) {
+        if (cellOf[i] < 0) continue;
+        int cx = cellOf[i] % cols, cy = cellOf[i] / cols;
+        for (int y=std::max(0, cy-1); y<=std::min(rows-1, cy+1); y++)
+            for (int x=std::max(0, cx-1); x<=std::min(cols-1, cx+1); x++) {
+                int c = y*cols + x;
+                for (int k=cellStart[c]; k<cellStart[c+1]; k++) {
+                    int j = order[k];
+                    if (j <= i) continue;
+                    float dx = balls[j].pos.x - balls[i].pos.x, dy = balls[j].pos.y - balls[i].pos.y;
+                    if (dx*dx + dy*dy < d2) { pairs.push_back(i); pairs.push_back(j); }
+                }
+            }
+    }
+    // restore the i<j double-loop order: i is already ascending, sort each i's partners
+    for (size_t p=first; p<pairs.size(); ) {
+        size_t q = p;
+        while (q < pairs.size() && pairs[q] == pairs[p]) q += 2;
+        for (size_t a=p+2; a<q; a+=2)
+            for (size_t b=a; b>p && pairs[b-1] > pairs[b+1]; b-=2) std::swap(pairs[b-1], pairs[b+1]);
+        p = q;
+    }
+}
+
+TableSim::TableSim(const TableLayout &layout) : layout(layout) {
+    balls.reserve(layout.config.balls);
+    reset();
+    reserveScratch();
+}
+
+// A ball is pocketed at most once per step (shotPocketed gets room for a few
+// scratches on top), and the grid finds about a dozen neighbours per ball
+// even when packed, so the capacities only move when the ball count does and
+// steady-state stepping never allocates.
+void TableSim::reserveScratch() {
+    const size_t n = balls.size();
+    if (pocketed.capacity() < n) pocketed.reserve(n);
+    if (shotPocketed.capacity() < 2*n) shotPocketed.reserve(2*n);
+    const size_t maxPairs = (useGrid && n > GRID_MIN_BALLS) ? 16*n : n*(n-1);
+    if (pairs.capacity() < maxPairs) pairs.reserve(maxPairs);
+    if (cx.capacity() < n) { cx.reserve(n); cy.reserve(n); cvx.reserve(n); cvy.reserve(n); }
+    solver.reserve((int)n, maxPairs);
+}
+
+void TableSim::gatherPairs(float reach) {
+    pairs.clear();
+    pairsLive = true;   // the grid leaves it to the solver
+    if (useGrid && balls.size() > GRID_MIN_BALLS) { grid.candidatePairs(balls, layout.table, reach, pairs); return; }
+    pairsLive = false;
+    for (size_t i=0;i<balls.size();++i) {
+        if (!balls[i].active) continue;
+        const Ball &a = balls[i];
+        for (size_t j=i+1;j<balls.size();++j) {
+            if (!balls[j].active) continue;
+            const Ball &b = balls[j];
+            float dx = b.pos.x - a.pos.x, dy = b.pos.y - a.pos.y;
+            if (dx*dx + dy*dy >= reach*reach) continue;
+            pairs.push_back((int)i); pairs.push_back((int)j);
+            if (!pairsLive) pairsLive = ContactLive(dx, dy, b.vel.x - a.vel.x, b.vel.y - a.vel.y, layout.ballR);
+        }
+    }
+}
+
+// touch < 0: a frame step, else an exact impact in advance()
+void TableSim::solveContacts(float touch) {
+    const int n = (int)balls.size();
+    cx.resize(n); cy.resize(n); cvx.resize(n); cvy.resize(n);
+    for (int i=0;i<n;i++) { cx[i] = balls[i].pos.x; cy[i] = balls[i].pos.y; cvx[i] = balls[i].vel.x; cvy[i] = balls[i].vel.y; }
+    ContactBodies bodies = { cx.data(), cy.data(), cvx.data(), cvy.data(), n };
+    if (touch < 0.0f) solver.solveStep(bodies, pairs, layout.ballR);
+    else solver.solveImpacts(bodies, pairs, layout.ballR, touch);
+    const std::vector<uint8_t> &moved = solver.touched();
+    for (int i=0;i<n;i++) {
+        if (!moved[i]) continue;
+        balls[i].pos = { cx[i], cy[i] };
+        balls[i].vel = { cvx[i], cvy[i] };
+        balls[i].restSteps = 0;
+    }
+}
+
+void TableSim::reset() {
+    const Rectangle &play = layout.play;
+    balls.clear();
+    balls.push_back({ { play.x + play.width*0.18f, play.y + play.height*0.5f }, {0,0}, true, 0, 0 });
+    Vector2 rackTip = { play.x + play.width*0.72f, play.y + play.height*0.5f };
+    float sep = (layout.ballR*2.0f) + (1.5f * layout.scale);
+    // rows of the rack from the apex, each centred on the long axis
+    auto row = [&](int r, int count, const int *ids) {
+        float x = rackTip.x + r*sep;
+        float y = rackTip.y - ((count-1)*sep)/2.0f;
+        for (int i=0;i<count;i++) balls.push_back({ { x, y + i*sep }, {0,0}, true, ids[i], 0 });
+    };
+    switch (layout.config.rack) {
+    case RACK_TRIANGLE: {
+        // rack 15
+        static const int order[15] = { 1, 15, 2, 9, 8, 3, 10, 4, 11, 5, 12, 6, 13, 7, 14 };
+        for (int r=0, k=0; r<5; k+=++r) row(r, r+1, order + k);
+        break;
+    }
+    case RACK_DIAMOND: {
+        // the 1 at the apex, the 9 in the middle
+        static const int order[9] = { 1, 2, 3, 4, 9, 5, 6, 7, 8 };
+        static const int rows[5] = { 1, 2, 3, 2, 1 };
+        for (int r=0, k=0; r<5; k+=rows[r++]) row(r, rows[r], order + k);
+        break;
+    }
+    case RACK_SNOOKER: {
+        // 15 reds (1-15) behind the pink, the colours (16-21) on their spots
+        static const int reds[15] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+        const float cy = play.y + play.height*0.5f, d = play.height*0.164f;
+        const float baulk = play.x + play.width*0.2065f, pink = play.x + play.width*0.75f;
+        rackTip.x = pink + sep;
+        for (int r=0, k=0; r<5; k+=++r) row(r, r+1, reds + k);
+        balls.push_back({ { baulk, cy + d }, {0,0}, true, 16, 0 });                     // yellow
+        balls.push_back({ { baulk, cy - d }, {0,0}, true, 17, 0 });                     // green
+        balls.push_back({ { baulk, cy }, {0,0}, true, 18, 0 });                         // brown
+        balls.push_back({ { play.x + play.width*0.5f, cy }, {0,0}, true, 19, 0 });     // blue
+        balls.push_back({ { pink, cy }, {0,0}, true, 20, 0 });                          // pink
+        balls.push_back({ { play.x + play.width*0.909f, cy }, {0,0}, true, 21, 0 });    // black
+        break;
+    }
+    }
+    pocketed.clear();
+    shotPocketed.clear();
+    solver.forget();
+    sleeping = false;
+}
+
+void TableSim::shoot(float angle, float power) {
+    balls[0].vel.x = cosf(angle) * (-power);
+    balls[0].vel.y = sinf(angle) * (-power);
+    balls[0].restSteps = 0;
+    sleeping = false;
+    shotPocketed.clear();
+    solver.forget();   // nothing carries over from the last shot
+}
+
+static Vector2 ClampToPlay(const TableLayout &layout, Vector2 p) {
+    const Rectangle &play = layout.play;
+    const float r = layout.ballR;
+    return { clampf_custom(p.x, play.x + r, play.x + play.width - r), clampf_custom(p.y, play.y + r, play.y + play.height - r) };
+}
+
+bool TableSim::canPlaceCueBall(Vector2 p) const {
+    p = ClampToPlay(layout, p);
+    const float r = layout.ballR;
+    for (size_t i=1;i<balls.size();++i) if (balls[i].active && Dist(p, balls[i].pos) < 2.0f*r + 1.0f) return false;
+    return true;
+}
+
+bool TableSim::placeCueBall(Vector2 p) {
+    if (!canPlaceCueBall(p)) return false;
+    p = ClampToPlay(layout, p);
+    balls[0].pos = p; balls[0].vel = {0,0};
+    balls[0].restSteps = 0;
+    sleeping = false;
+    return true;
+}
+
+void TableSim::spotCueBall() {
+    const Rectangle &play = layout.play;
+    balls[0].pos = { play.x + play.width*0.18f, play.y + play.height*0.5f };
+    balls[0].vel = {0,0};
+    balls[0].restSteps = 0;
+    sleeping = false;
+}
+
+void TableSim::step() {
+    const float BALL_R = layout.ballR;
+    const TableField &field = *layout.field;
+    reserveScratch();
+    pocketed.clear();
+
+    // move balls (sleeping ones stay put and skip every per-ball test)
+    PROFILE_BEGIN(integrateStart);
+    for (auto &b : balls) {
+        if (!b.active || b.asleep()) continue;
+        b.pos.x += b.vel.x;
+        b.pos.y += b.vel.y;
+        b.vel.x *= FRICTION;
+        b.vel.y *= FRICTION;
+        if (fabs(b.vel.x) < MIN_VEL) b.vel.x = 0.0f;
+        if (fabs(b.vel.y) < MIN_VEL) b.vel.y = 0.0f;
+    }
+    PROFILE_END(integrateStart, PROF_INTEGRATE);
+
+    // ball-ball collisions. Candidates get slack so pairs that push-outs in
+    // this step bring into contact (or that close in on each other) are seen.
+    PROFILE_BEGIN(collideStart);
+    gatherPairs(4.0f*BALL_R);
+    if (sequentialContacts) {
+        for (size_t p=0;p<pairs.size();p+=2) {
+            Ball &A = balls[pairs[p]], &B = balls[pairs[p+1]];
+            if (!A.asleep() || !B.asleep()) ResolveBallCollision(A, B, BALL_R);
+        }
+    } else if (pairsLive) {
+        solveContacts(-1.0f);
+    } else {
+        solver.forget();   // what solveStep() does with nothing touching
+    }
+    PROFILE_END(collideStart, PROF_COLLIDE);
+
+    // cushion separation & reflect: one field lookup per ball covers rails and jaws
+    PROFILE_BEGIN(cushionStart);
+    for (auto &b : balls) {
+        if (!b.active || b.asleep()) continue;
+        float depth; Vector2 n;
+        if (!field.contact(b.pos, depth, n)) continue;
+        b.pos.x += n.x * depth;
+        b.pos.y += n.y * depth;
+        float vdot = b.vel.x*n.x + b.vel.y*n.y;
+        if (vdot < 0.0f) {
+            b.vel.x -= 2.0f * vdot * n.x;
+            b.vel.y -= 2.0f * vdot * n.y;
+            b.vel.x *= RESTITUTION; b.vel.y *= RESTITUTION;
+        }
+        b.restSteps = 0;
+    }
+    PROFILE_END(cushionStart, PROF_CUSHIONS);
+
+    // pockets detection
+    PROFILE_BEGIN(pocketStart);
+    for (auto &b : balls) {
+        if (!b.active || b.asleep()) continue;
+        if (field.pocketAt(b.pos) < 0) continue;
+        pocketed.push_back(b.id);
+        shotPocketed.push_back(b.id);
+        if (b.id != 0) b.active = false;
+        // cue ball goes back on the spot (ball-in-hand is the caller's rule)
+    }
+    for (int id : pocketed) if (id == 0) spotCueBall();
+    PROFILE_END(pocketStart, PROF_POCKETS);
+
+    // A ball that ends a step stopped has had its final position clamped,
+    // collided, cushioned and pocket-tested; one more quiet step and it sleeps.
+    sleeping = true;
+    for (auto &b : balls) {
+        if (!b.active) continue;
+        if (b.vel.x != 0.0f || b.vel.y != 0.0f) b.restSteps = 0;
+        else if (b.restSteps < 2) b.restSteps++;
+        if (!b.asleep()) sleeping = false;
+    }
+}
+
+void TableSim::resolveImpacts(float touch) {
+    gatherPairs(2.0f*layout.ballR + touch);
+    solveContacts(touch);
+}
+
+int TableSim::stepUntilRest(int maxSteps) {
+    int n = 0;
+    while (n < maxSteps && !atRest()) { step(); n++; }
+    return n;
+}
+
+bool TableSim::atRest() const {
+    for (auto &b : balls) if (b.active && (b.vel.x != 0.0f || b.vel.y != 0.0f)) return false;
+    return true;
+}
+
+void TableSim::wakeAll() {
+    for (auto &b : balls) b.restSteps = 0;
+    sleeping = false;
+}
+
+bool TableSim::allVerySlow() const {
+    for (auto &b: balls) {
+        if (!b.active) continue;
+        float speed = sqrtf(b.vel.x*b.vel.x + b.vel.y*b.vel.y);
+        if (speed > SLOW_THRESHOLD) return false;
+    }
+    return true;
+}
+
+int TableSim::activeObjectBalls() const {
+    int n = 0;
+    for (size_t i=1;i<balls.size();++i) if (balls[i].active) n++;
+    return n;
+}
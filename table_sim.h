@@ -0,0 +1,254 @@
+// Window-free table physics shared by the game and the headless tools.
+// Builds without raylib; the headless CLI's full build line is at the top of
+// billiard_sim.cpp.
+
+#ifndef TABLE_SIM_H
+#define TABLE_SIM_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "contact_solver.h"
+
+// Only raylib's plain math structs are needed here; headless builds without
+// raylib installed get layout-identical definitions.
+#if __has_include("raylib.h")
+#include "raylib.h"
+#else
+typedef struct Vector2 { float x; float y; } Vector2;
+typedef struct Rectangle { float x; float y; float width; float height; } Rectangle;
+#endif
+
+// physics params
+const float FRICTION = 0.992f;
+const float MIN_VEL = 0.04f;
+const float RESTITUTION = 0.98f;
+const float MAX_POWER = 20.0f;
+const float SLOW_THRESHOLD = 0.08f; // very slow threshold (for early end)
+
+static inline float clampf_custom(float v, float lo, float hi) { return fmaxf(lo, fminf(v, hi)); }
+static inline float Dist(const Vector2 &a,const Vector2 &b){ float dx=a.x-b.x, dy=a.y-b.y; return sqrtf(dx*dx+dy*dy); }
+static inline float Dot(const Vector2 &a,const Vector2 &b){ return a.x*b.x + a.y*b.y; }
+
+struct Segment { Vector2 a,b; };
+
+// Closest point on segment to p
+Vector2 ClosestPointOnSegment(const Vector2 &a, const Vector2 &b, const Vector2 &p, float &tOut);
+
+// ---------------- Ball & collision ----------------
+struct Ball {
+    Vector2 pos;
+    Vector2 vel;
+    bool active;
+    int id;
+    // Whole steps spent at rest without being pushed. After two, step() skips
+    // the ball until a collision wakes it (anything that moves it resets this).
+    unsigned char restSteps;
+
+    bool asleep() const { return restSteps >= 2; }
+};
+
+// Wakes both balls when they touch.
+void ResolveBallCollision(Ball &A, Ball &B, float r);
+
+class TableField;
+
+// ---------------- Table variants ----------------
+enum RackShape { RACK_TRIANGLE, RACK_DIAMOND, RACK_SNOOKER };
+
+// A table and its rack. Sizes are in units of the game's 840-long table and
+// scale with the window the same way. keyBall is only read by the headless
+// benchmark to decide when to re-rack; the game rules (game_rules.h) are
+// 8-ball only and always treat ball 8 as the key ball.
+struct TableConfig {
+    const char *name;
+    float aspect;           // table length over width
+    float ballR, holeR;
+    int pockets;            // 6, or 4 (corners only)
+    int balls;              // cue ball included
+    RackShape rack;
+    int keyBall;            // pocketing it ends the rack; -1: only a clear table does
+};
+
+const int TABLE_MAX_POCKETS = 6;
+
+constexpr TableConfig TABLE_8BALL = { "8ball", 840.0f/490.0f, 12.0f, 26.0f, 6, 16, RACK_TRIANGLE, 8 };
+constexpr TableConfig TABLE_9BALL = { "9ball", 840.0f/490.0f, 12.0f, 26.0f, 6, 10, RACK_DIAMOND, 9 };
+constexpr TableConfig TABLE_4POCKET = { "4pocket", 840.0f/490.0f, 12.0f, 26.0f, 4, 16, RACK_TRIANGLE, 8 };
+// a 12 ft table: balls and pockets at about their real size against it
+constexpr TableConfig TABLE_SNOOKER = { "snooker", 2.0f, 6.2f, 11.0f, 6, 22, RACK_SNOOKER, -1 };
+
+// nullptr when there is no such variant
+const TableConfig *FindTableConfig(const char *name);
+std::string TableConfigNames();
+
+// Table geometry derived from the window size exactly like the game lays it out.
+struct TableLayout {
+    TableConfig config = TABLE_8BALL;
+    Rectangle table;
+    Rectangle play;
+    float scale;
+    float ballR;
+    float holeR;
+    Vector2 holes[TABLE_MAX_POCKETS];   // the first config.pockets are used
+    // Cushion noses: all four rails cut back at the pockets, plus a jaw on
+    // each rail end running out to the table edge.
+    std::vector<Segment> cushions;
+    // the same boundary baked for per-ball lookups; shared by copies
+    std::shared_ptr<const TableField> field;
+};
+
+const float CUSHION_OFFSET = 14.0f;
+
+// ballScale < 1 keeps balls and pockets smaller than the table would imply
+// (big stress tables with many balls at normal ball size).
+TableLayout MakeTableLayout(const TableConfig &config, int screenW, int screenH, float ballScale = 1.0f);
+// the 8-ball table
+inline TableLayout MakeTableLayout(int screenW, int screenH, float ballScale = 1.0f) {
+    return MakeTableLayout(TABLE_8BALL, screenW, screenH, ballScale);
+}
+
+// Signed distance from a ball centre to cushion contact (distance to the
+// nearest cushion segment less one ball radius, negative when overlapping or
+// behind a cushion) and its gradient, sampled on nodes ballR/4 apart. Within
+// half a node the field is extended linearly, which is exact along the rails.
+// Only 16x16-node tiles near a cushion or a pocket are stored; a lookup
+// anywhere else just says how far the nearest cushion is at least.
+class TableField {
+public:
+    // outline: closed polygon around the cloth and pocket mouths, only used
+    // to tell which side of a cushion a point is on
+    void build(const TableLayout &L, const std::vector<Vector2> &outline);
+
+    // true when a ball at p touches a cushion: depth to push it out along
+    // normal (unit, pointing back onto the cloth)
+    bool contact(Vector2 p, float &depth, Vector2 &normal) const {
+        float bound = 0.0f; Vector2 q; const Node *n = at(p, q, bound);
+        if (!n) return false;
+        float d = n->d + n->nx*(p.x - q.x) + n->ny*(p.y - q.y);
+        if (d >= 0.0f) return false;
+        depth = -d; normal = { n->nx, n->ny };
+        return true;
+    }
+    // a lower bound on how far a ball at p can move before touching a cushion
+    float clearance(Vector2 p) const {
+        float bound = 0.0f; Vector2 q; const Node *n = at(p, q, bound);
+        if (!n) return bound;
+        return n->d - Dist(p, q);
+    }
+    // the hole a ball at p drops into (closer than holeR - 4), or -1
+    int pocketAt(Vector2 p) const {
+        float bound = 0.0f; Vector2 q; const Node *n = at(p, q, bound);
+        if (!n || n->pocket < 0 || Dist(p, holes[n->pocket]) >= captureR) return -1;
+        return n->pocket;
+    }
+
+    size_t storedTiles() const { return nodes.size() / TILE_NODES; }
+    size_t totalTiles() const { return tileSlot.size(); }
+
+private:
+    static const int TILE = 16, TILE_NODES = TILE*TILE;
+    struct Node { float d, nx, ny; int8_t pocket; };
+
+    Vector2 origin = { 0, 0 };
+    float spacing = 1.0f, inv = 1.0f;
+    int tilesX = 0, tilesY = 0;
+    std::vector<int> tileSlot;      // index into nodes / TILE_NODES, -1 = clear
+    std::vector<float> tileFloor;   // clear tiles: lower bound of the distance
+    std::vector<Node> nodes;
+    Vector2 holes[TABLE_MAX_POCKETS];
+    int pocketCount = 0;
+    float captureR = 0.0f;
+
+    // nearest node to p and its position q, or nullptr (with bound) when
+    // its tile is clear
+    const Node *at(Vector2 p, Vector2 &q, float &bound) const {
+        int ix = (int)((p.x - origin.x)*inv + 0.5f), iy = (int)((p.y - origin.y)*inv + 0.5f);
+        ix = ix < 0 ? 0 : (ix >= tilesX*TILE ? tilesX*TILE - 1 : ix);
+        iy = iy < 0 ? 0 : (iy >= tilesY*TILE ? tilesY*TILE - 1 : iy);
+        int t = (iy / TILE)*tilesX + ix / TILE;
+        int slot = tileSlot[t];
+        if (slot < 0) { bound = tileFloor[t]; return nullptr; }
+        q = { origin.x + ix*spacing, origin.y + iy*spacing };
+        return &nodes[(size_t)slot*TILE_NODES + (iy % TILE)*TILE + ix % TILE];
+    }
+};
+
+// Broad-phase for ball-ball contacts: a uniform grid over the table with cells
+// one query distance wide, rebuilt by counting sort every step.
+class BallGrid {
+public:
+    // Appends i,j (i < j, sorted) for active pairs whose centres are closer than dist.
+    void candidatePairs(const std::vector<Ball> &balls, const Rectangle &bounds, float dist, std::vector<int> &pairs);
+private:
+    int cols = 0, rows = 0;
+    std::vector<int> cellOf;     // per ball, -1 when inactive
+    std::vector<int> cellStart;  // cols*rows + 1 offsets into order
+    std::vector<int> order;      // ball indices grouped by cell
+};
+
+// One table's worth of balls advanced one game frame per step().
+class TableSim {
+public:
+    TableLayout layout;
+    std::vector<Ball> balls;
+    std::vector<int> pocketed;      // ids pocketed during the last step()
+    std::vector<int> shotPocketed;  // ids pocketed since the last shoot()
+    long events = 0;                // events processed by advance() so far
+    bool sleeping = false;          // every active ball asleep after the last step()/advance()
+    bool useGrid = true;            // false: test every pair in step() (O(n^2))
+    static const size_t GRID_MIN_BALLS = 32;  // a plain rack is cheaper brute force
+    // Ball-ball contacts in step() and impacts in advance(); its pass budgets
+    // can be tuned. sequentialContacts = true brings back step()'s old single
+    // in-order pass of ResolveBallCollision (for comparison).
+    ContactSolver solver;
+    bool sequentialContacts = false;
+
+    explicit TableSim(const TableLayout &layout);
+
+    // cue on left, rack right
+    void reset();
+    // Cue ball velocity points away from the aim direction, as with the mouse cue.
+    void shoot(float angle, float power);
+    // Ball-in-hand: clamps p into the play area; false if it overlaps a ball.
+    bool placeCueBall(Vector2 p);
+    // whether placeCueBall(p) would succeed, without moving anything
+    bool canPlaceCueBall(Vector2 p) const;
+    void spotCueBall();
+
+    void step();
+    // Returns the number of steps taken (capped at maxSteps).
+    int stepUntilRest(int maxSteps = 20000);
+
+    // Event-driven alternative to step() (table_events.cpp): jumps straight
+    // between exact times of impact under the same per-frame FRICTION decay,
+    // so the outcome does not depend on how time is sliced. Time is in frames.
+    void advance(float frames);
+    // Returns the frames simulated until every ball stopped (capped at maxFrames).
+    float advanceUntilRest(float maxFrames = 20000.0f);
+    // Bounces every pair within touch of contact and closing, all at once
+    // (advance() at a ball-ball impact).
+    void resolveImpacts(float touch);
+
+    bool atRest() const;
+    void wakeAll();
+    // every active ball below SLOW_THRESHOLD (the game's early turn end)
+    bool allVerySlow() const;
+    int activeObjectBalls() const;
+
+private:
+    BallGrid grid;
+    std::vector<int> pairs;
+    bool pairsLive = false;                // some pair needs the solver (ContactLive)
+    std::vector<float> cx, cy, cvx, cvy;   // the balls as the solver's arrays
+
+    // candidate pairs: active balls closer than reach, in i<j order
+    void gatherPairs(float reach);
+    void solveContacts(float touch);
+
+    void reserveScratch();
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "table_wall.h"
+#include "shot_ai.h"
+#include <algorithm>
+#include <chrono>
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TableWall::TableWall(const TableLayout &layout, int tables, int threads, const ScriptedPlayer &p1, const ScriptedPlayer &p2, unsigned seed)
+    : layout(layout), p1(p1), p2(p2), pool(threads) {
+    this->tables.reserve(tables);
+    for (int i=0;i<tables;i++) {
+        this->tables.emplace_back(layout);
+        Table &t = this->tables.back();
+        t.rng.seed(seed + (unsigned)i);
+        // staggered breaks, so the wall is never all racks at once
+        t.pause = -(int)(t.rng() % 120);
+    }
+    for (auto &v : views) v.resize(tables);
+    for (int i=0;i<tables;i++) publish(this->tables[i], views[front][i]);
+}
+
+bool TableWall::addReplay(const std::vector<uint8_t> &data, std::string *error) {
+    if (replays >= size()) { if (error) *error = "more replays than tables"; return false; }
+    std::unique_ptr<ReplayPlayer> r(new ReplayPlayer(layout));
+    if (!r->load(data, error)) return false;
+    Table &t = tables[replays++];
+    t.replay = std::move(r);
+    t.pause = 0;
+    publish(t, views[front][replays - 1]);
+    return true;
+}
+
+void TableWall::tick(Table &t) {
+    if (t.replay) {
+        ReplayPlayer &r = *t.replay;
+        if (r.tick < r.endTick()) r.stepTick();
+        else if (++t.pause > WALL_GAME_PAUSE) { r.seek(0); t.pause = 0; t.games++; }
+        return;
+    }
+    TableSim &sim = t.sim;
+    TurnState &turn = t.turn;
+    if (turn.gameOver || t.shots >= TOURNAMENT_MAX_SHOTS) {
+        if (++t.pause > WALL_GAME_PAUSE) { NewGame(sim, turn); t.pause = 0; t.shots = 0; t.games++; }
+        return;
+    }
+    if (!turn.shotInProgress) {
+        if (turn.waitingPlacement) {
+            if (!sim.placeCueBall(ChooseCuePlacement(sim))) sim.spotCueBall();
+            turn.waitingPlacement = false;
+        }
+        if (++t.pause < WALL_SHOT_PAUSE) return;
+        t.pause = 0;
+        float angle, power;
+        (turn.currentPlayer == 1 ? p1 : p2).shot(sim, t.rng, angle, power);
+        sim.shoot(angle, power);
+        turn.shotInProgress = true;
+        turn.slowTimer = 0.0f;
+        t.shots++;
+    }
+    RulesTick(sim, turn, GAME_SUBSTEPS, GAME_TICK_DT);
+}
+
+void TableWall::publish(const Table &t, WallTableView &v) const {
+    const TableSim &sim = t.replay ? t.replay->sim : t.sim;
+    const TurnState &turn = t.replay ? t.replay->turn : t.turn;
+    v.count = (uint8_t)std::min(sim.balls.size(), (size_t)SNAPSHOT_MAX_BALLS);
+    std::copy(sim.balls.begin(), sim.balls.begin() + v.count, v.balls);
+    for (int s=0;s<3;s++) v.score[s] = turn.score[s];
+    v.currentPlayer = turn.currentPlayer;
+    v.gameOver = turn.gameOver;
+    v.replay = t.replay != nullptr;
+    v.moving = turn.shotInProgress;
+    v.games = t.games;
+}
+
+void TableWall::beginTick() {
+    if (running) endTick();
+    running = true;
+    startMs = NowMs();
+    std::vector<WallTableView> &back = views[1 - front];
+    // a few chunks per worker evens out tables that happen to be mid-break
+    const int n = size();
+    const int chunks = std::min(n, std::max(1, pool.size() * 4));
+    for (int c=0;c<chunks;c++) {
+        int lo = n * c / chunks, hi = n * (c + 1) / chunks;
+        pool.submit([this, &back, lo, hi] {
+            for (int i=lo;i<hi;i++) {
+                tick(tables[i]);
+                publish(tables[i], back[i]);
+            }
+        });
+    }
+}
+
+void TableWall::endTick() {
+    if (!running) return;
+    pool.wait();
+    running = false;
+    tickMs = NowMs() - startMs;
+    front = 1 - front;
+    ticks++;
+}
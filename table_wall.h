@@ -0,0 +1,87 @@
+// A wall of tables playing on their own, for spectator displays.
+// Each table is either a scripted game (tournament players, re-racked when
+// it ends) or a replay (looped). Every physics tick of every table runs on a
+// ThreadPool into the back half of a double-buffered set of views, while the
+// caller (the render thread) reads the front half; endTick() swaps them.
+// Only views cross threads: a few hundred bytes per table, no TableSim.
+
+#ifndef TABLE_WALL_H
+#define TABLE_WALL_H
+
+#include "table_sim.h"
+#include "game_rules.h"
+#include "game_snapshot.h"
+#include "replay.h"
+#include "thread_pool.h"
+#include "tournament.h"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+const int WALL_SHOT_PAUSE = 45;        // ticks between a table coming to rest and the next shot
+const int WALL_GAME_PAUSE = 180;       // ticks a finished game (or replay) stays up
+
+// what the render thread sees of one table
+struct WallTableView {
+    Ball balls[SNAPSHOT_MAX_BALLS];
+    uint8_t count = 0;
+    int score[3] = { 0, 0, 0 };
+    int currentPlayer = 1;
+    bool gameOver = false;
+    bool replay = false;
+    bool moving = false;
+    int games = 0;                     // finished on this table so far
+};
+
+class TableWall {
+public:
+    // threads <= 0 uses every hardware thread
+    TableWall(const TableLayout &layout, int tables, int threads, const ScriptedPlayer &p1, const ScriptedPlayer &p2, unsigned seed);
+    TableWall(const TableWall &) = delete;
+    TableWall &operator=(const TableWall &) = delete;
+
+    // The next scripted table plays this replay (looped) instead; false with
+    // a reason when it does not load or every table is taken.
+    bool addReplay(const std::vector<uint8_t> &data, std::string *error = nullptr);
+
+    int size() const { return (int)tables.size(); }
+    int threads() const { return pool.size(); }
+    // Starts one physics tick of every table on the workers. The views from
+    // the last endTick() stay valid and unchanged until the next one.
+    void beginTick();
+    // waits for the tick started by beginTick() and publishes its views
+    void endTick();
+    const WallTableView &view(int i) const { return views[front][i]; }
+
+    long ticks = 0;
+    double tickMs = 0.0;               // beginTick() to the workers finishing, last tick
+
+private:
+    struct Table {
+        TableSim sim;
+        TurnState turn;
+        std::mt19937 rng;
+        int pause = 0;
+        int shots = 0;
+        int games = 0;
+        std::unique_ptr<ReplayPlayer> replay;
+        explicit Table(const TableLayout &layout) : sim(layout) {}
+    };
+
+    TableLayout layout;
+    const ScriptedPlayer &p1, &p2;
+    std::vector<Table> tables;
+    std::vector<WallTableView> views[2];
+    int front = 0;
+    int replays = 0;
+    bool running = false;
+    double startMs = 0.0;
+    ThreadPool pool;
+
+    void tick(Table &t);
+    void publish(const Table &t, WallTableView &v) const;
+};
+
+#endif
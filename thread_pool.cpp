@@ -0,0 +1,92 @@
+#include "thread_pool.h"
+
+// index of the pool worker running on this thread, -1 elsewhere
+static thread_local const ThreadPool *tlsPool = nullptr;
+static thread_local int tlsWorker = -1;
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    for (int i=0;i<threads;i++) queues.emplace_back(new Queue());
+    for (int i=0;i<threads;i++) workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+    for (auto &t : workers) t.join();
+}
+
+int ThreadPool::worker() const {
+    return tlsPool == this ? tlsWorker : -1;
+}
+
+void ThreadPool::push(Task &t) {
+    int q = (tlsPool == this) ? tlsWorker : (int)(nextQueue++ % queues.size());
+    {
+        Queue &queue = *queues[q];
+        std::lock_guard<std::mutex> lock(queue.m);
+        if (queue.count < QUEUE_TASKS) {
+            queue.tasks[(queue.head + queue.count) % QUEUE_TASKS].takeFrom(t);
+            queue.count++;
+            pending++;
+        }
+    }
+    if (t.run) { t.run(t.data); return; }   // the ring was full
+    queued++;
+    // take the lock so a worker between its empty check and its wait sees this
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    sleepCv.notify_one();
+}
+
+bool ThreadPool::runOne(int self) {
+    Task task;
+    int n = (int)queues.size();
+    // own queue newest-first (cache warm), then steal oldest-first from the others
+    if (self >= 0) {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.m);
+        if (own.count > 0) task.takeFrom(own.tasks[(own.head + --own.count) % QUEUE_TASKS]);
+    }
+    for (int k=1; !task.run && k<=n; k++) {
+        Queue &victim = *queues[(self + k + n) % n];
+        std::lock_guard<std::mutex> lock(victim.m);
+        if (victim.count == 0) continue;
+        task.takeFrom(victim.tasks[victim.head]);
+        victim.head = (victim.head + 1) % QUEUE_TASKS;
+        victim.count--;
+    }
+    if (!task.run) return false;
+    queued--;
+    task.run(task.data);
+    if (--pending == 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        doneCv.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(int self) {
+    tlsPool = this;
+    tlsWorker = self;
+    while (true) {
+        if (runOne(self)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping) return;
+        sleepCv.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping) return;
+    }
+}
+
+void ThreadPool::wait() {
+    int self = (tlsPool == this) ? tlsWorker : -1;
+    while (pending > 0) {
+        if (runOne(self)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        doneCv.wait_for(lock, std::chrono::milliseconds(1), [this] { return pending == 0; });
+    }
+}
@@ -0,0 +1,78 @@
+// Small work-stealing thread pool for the headless search and batch tools.
+// Every worker owns a queue: it pops its own newest task and, when empty,
+// steals the oldest task from another worker.
+//
+// Queues are fixed rings and a task is stored inline in its slot, so
+// submitting never allocates (the computer player searches through here
+// during play). A task whose queue is full runs at once on the caller.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads <= 0 uses every hardware thread
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return (int)workers.size(); }
+    // index of the worker running the call, -1 on any other thread
+    int worker() const;
+
+    static const int TASK_BYTES = 64;     // a task's captures
+    static const int QUEUE_TASKS = 256;   // ring slots per worker
+
+    // From a worker the task goes on that worker's own queue.
+    template <class F>
+    void submit(F task) {
+        static_assert(sizeof(F) <= TASK_BYTES && alignof(F) <= alignof(std::max_align_t),
+                      "tasks are stored in the queue; capture a pointer to anything bigger");
+        Task t;
+        new (t.data) F(std::move(task));
+        t.run = [](void *p) { F &f = *static_cast<F *>(p); f(); f.~F(); };
+        t.move = [](void *from, void *to) { F &f = *static_cast<F *>(from); new (to) F(std::move(f)); f.~F(); };
+        push(t);
+    }
+    // Blocks until every submitted task has finished; the caller runs tasks too.
+    void wait();
+
+private:
+    struct Task {
+        alignas(std::max_align_t) unsigned char data[TASK_BYTES];
+        void (*run)(void *) = nullptr;               // calls the callable, then destroys it
+        void (*move)(void *, void *) = nullptr;      // moves it to another slot
+        void takeFrom(Task &o) { o.move(o.data, data); run = o.run; move = o.move; o.run = nullptr; }
+    };
+    struct Queue {
+        std::mutex m;
+        Task tasks[QUEUE_TASKS];
+        int head = 0, count = 0;    // oldest task, tasks in the ring
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> pending{0};    // submitted and not finished
+    std::atomic<int> queued{0};     // still sitting in a deque
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    std::condition_variable doneCv;
+
+    void push(Task &t);
+    bool runOne(int self);
+    void workerLoop(int self);
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "tournament.h"
+#include "game_rules.h"
+#include "shot_ai.h"
+#include "table_query.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// ---------------- scripted players ----------------
+
+static void RandomShot(const TableSim &, std::mt19937 &rng, float &angle, float &power) {
+    std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f), powerDist(2.0f, MAX_POWER);
+    angle = angleDist(rng);
+    power = powerDist(rng);
+}
+
+// something other than skip/skip2 in the way of a ball rolling from start along dir
+static bool PathBlocked(const TableSim &sim, Vector2 start, Vector2 dir, float dist, int skip, int skip2) {
+    const float R = sim.layout.ballR;
+    SweepHit hit;
+    for (auto &o : sim.balls) {
+        if (!o.active || o.id == skip || o.id == skip2) continue;
+        if (SweepCircleVsCircle(start, dir, dist, R, o.pos, R, hit)) return true;
+    }
+    return false;
+}
+
+// Straight pots by the ghost-ball method: the unobstructed ball/pocket pair
+// with the thinnest cut and shortest travel, with a little aiming error.
+static void AimShot(const TableSim &sim, std::mt19937 &rng, float &angle, float &power) {
+    const TableLayout &L = sim.layout;
+    const float R = L.ballR;
+    Vector2 cue = sim.balls[0].pos;
+    float bestScore = 0.0f, bestAngle = 0.0f, bestTravel = 0.0f;
+    for (auto &b : sim.balls) {
+        if (!b.active || b.id == 0) continue;
+        for (int p=0;p<L.config.pockets;p++) {
+            const Vector2 &h = L.holes[p];
+            float d2 = Dist(b.pos, h);
+            if (d2 < 1e-3f) continue;
+            Vector2 u = { (h.x - b.pos.x) / d2, (h.y - b.pos.y) / d2 };
+            Vector2 ghost = { b.pos.x - u.x*2.0f*R, b.pos.y - u.y*2.0f*R };
+            float d1 = Dist(cue, ghost);
+            if (d1 < 1e-3f) continue;
+            Vector2 v = { (ghost.x - cue.x) / d1, (ghost.y - cue.y) / d1 };
+            float cut = Dot(u, v);
+            if (cut < 0.25f) continue;   // thinner than ~75 degrees
+            float score = cut / (d1 + d2);
+            if (score <= bestScore) continue;
+            if (PathBlocked(sim, cue, v, d1, 0, b.id) || PathBlocked(sim, b.pos, u, d2, b.id, b.id)) continue;
+            bestScore = score;
+            bestAngle = atan2f(v.y, v.x);
+            bestTravel = d1 + d2 / cut;
+        }
+    }
+    if (bestScore <= 0.0f) { RandomShot(sim, rng, angle, power); return; }
+    std::normal_distribution<float> aimError(0.0f, 0.01f);
+    angle = bestAngle + 3.14159265f + aimError(rng);   // the mouse sits behind the cue ball
+    // a ball at speed v rolls about v / (1 - FRICTION) before stopping
+    power = clampf_custom(2.0f + 1.6f * bestTravel * (1.0f - FRICTION), 3.0f, MAX_POWER);
+}
+
+static const ScriptedPlayer PLAYERS[] = {
+    { "random", RandomShot },
+    { "aim", AimShot },
+};
+
+const ScriptedPlayer *FindScriptedPlayer(const char *name) {
+    for (auto &p : PLAYERS) if (std::string(p.name) == name) return &p;
+    return nullptr;
+}
+
+std::string ScriptedPlayerNames() {
+    std::string names;
+    for (auto &p : PLAYERS) names += (names.empty() ? "" : "|") + std::string(p.name);
+    return names;
+}
+
+// ---------------- games ----------------
+
+GameResult PlayScriptedGame(const TableLayout &layout, const ScriptedPlayer &p1, const ScriptedPlayer &p2, unsigned seed) {
+    TableSim sim(layout);
+    TurnState turn;
+    std::mt19937 rng(seed);
+    GameResult res;
+    while (!turn.gameOver) {
+        if (!turn.shotInProgress) {
+            int seat = turn.currentPlayer;
+            if (res.shots[1] + res.shots[2] >= TOURNAMENT_MAX_SHOTS) break;
+            if (turn.waitingPlacement) {
+                if (!sim.placeCueBall(ChooseCuePlacement(sim))) sim.spotCueBall();
+                turn.waitingPlacement = false;
+            }
+            float angle, power;
+            (seat == 1 ? p1 : p2).shot(sim, rng, angle, power);
+            sim.shoot(angle, power);
+            turn.shotInProgress = true;
+            turn.slowTimer = 0.0f;
+            res.shots[seat]++;
+        }
+        int mover = turn.currentPlayer;
+        bool wasWaiting = turn.waitingPlacement;
+        RulesTick(sim, turn, GAME_SUBSTEPS, GAME_TICK_DT);
+        res.ticks++;
+        if (!wasWaiting && turn.waitingPlacement) res.fouls[mover]++;
+    }
+    res.winner = turn.gameOver ? turn.winner : -1;
+    for (int s=1;s<=2;s++) res.score[s] = turn.score[s];
+    return res;
+}
+
+TournamentStats RunTournament(const ScriptedPlayer &a, const ScriptedPlayer &b, long games, int threads, unsigned seed, FILE *out) {
+    const TableLayout layout = MakeTableLayout(1000, 650);
+    TournamentStats total;
+    std::mutex m;   // guards total and out
+    std::atomic<long> next{0};
+    if (out) fprintf(out, "game,breaker,winner,shots_a,shots_b,fouls_a,fouls_b,score_a,score_b,ticks\n");
+
+    auto t0 = std::chrono::steady_clock::now();
+    ThreadPool pool(threads);
+    // one long-running loop per worker pulling game numbers, so a million
+    // games are not a million tasks
+    auto play = [&] {
+        TournamentStats local;
+        for (long g; (g = next++) < games; ) {
+            bool aBreaks = g % 2 == 0;
+            GameResult r = aBreaks ? PlayScriptedGame(layout, a, b, seed + (unsigned)g)
+                                   : PlayScriptedGame(layout, b, a, seed + (unsigned)g);
+            int seatA = aBreaks ? 1 : 2, seatB = 3 - seatA;
+            local.games++;
+            if (r.winner < 0) local.draws++;
+            else local.wins[r.winner == seatA ? 0 : 1]++;
+            local.shots[0] += r.shots[seatA]; local.shots[1] += r.shots[seatB];
+            local.fouls[0] += r.fouls[seatA]; local.fouls[1] += r.fouls[seatB];
+            if (out) {
+                std::lock_guard<std::mutex> lock(m);
+                fprintf(out, "%ld,%s,%s,%d,%d,%d,%d,%d,%d,%u\n", g, aBreaks ? "a" : "b",
+                        r.winner < 0 ? "draw" : (r.winner == seatA ? "a" : "b"),
+                        r.shots[seatA], r.shots[seatB], r.fouls[seatA], r.fouls[seatB], r.score[seatA], r.score[seatB], r.ticks);
+            }
+        }
+        std::lock_guard<std::mutex> lock(m);
+        total.games += local.games;
+        total.draws += local.draws;
+        for (int i=0;i<2;i++) {
+            total.wins[i] += local.wins[i];
+            total.shots[i] += local.shots[i];
+            total.fouls[i] += local.fouls[i];
+        }
+    };
+    for (int w=0; w<pool.size(); w++) pool.submit([&play] { play(); });
+    pool.wait();
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return total;
+}
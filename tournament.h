@@ -0,0 +1,54 @@
+// Headless complete games between scripted players, many at once on a
+// ThreadPool, for checking rule changes over millions of games.
+// Games go tick by tick through RulesTick exactly like the window loop, the
+// next shot following as soon as the turn ends; ball in hand is placed with
+// ChooseCuePlacement.
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "table_sim.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+struct ScriptedPlayer {
+    const char *name;
+    // the shot for the player to move, as shoot() takes it (the mouse aim)
+    void (*shot)(const TableSim &sim, std::mt19937 &rng, float &angle, float &power);
+};
+
+// nullptr when unknown
+const ScriptedPlayer *FindScriptedPlayer(const char *name);
+// "random|aim|..." for usage text
+std::string ScriptedPlayerNames();
+
+// games that reach this many shots are a draw
+const int TOURNAMENT_MAX_SHOTS = 400;
+
+struct GameResult {
+    int winner = -1;              // seat 1 or 2; -1 a draw
+    int score[3] = { 0, 0, 0 };
+    int shots[3] = { 0, 0, 0 };
+    int fouls[3] = { 0, 0, 0 };   // scratches, by the seat that shot
+    uint32_t ticks = 0;
+};
+
+// p1 breaks; the whole game is a function of the seed
+GameResult PlayScriptedGame(const TableLayout &layout, const ScriptedPlayer &p1, const ScriptedPlayer &p2, unsigned seed);
+
+// totals by script: game g is seeded seed + g and A breaks in even games
+struct TournamentStats {
+    long games = 0;
+    long wins[2] = { 0, 0 };      // A, B
+    long draws = 0;
+    long shots[2] = { 0, 0 };
+    long fouls[2] = { 0, 0 };
+    double seconds = 0.0;
+};
+
+// Streams one CSV line per finished game to out (when given), in finishing order.
+TournamentStats RunTournament(const ScriptedPlayer &a, const ScriptedPlayer &b, long games, int threads, unsigned seed, FILE *out);
+
+#endif